@@ -0,0 +1,18 @@
+CPMAddPackage(
+  NAME basisu
+  GITHUB_REPOSITORY BinomialLLC/basis_universal
+  GIT_TAG 1.16.4
+  DOWNLOAD_ONLY YES
+)
+
+# only the transcoder and the zstd decoder for supercompressed UASTC, nothing is encoded at runtime
+add_library(BasisTranscoder
+     ${basisu_SOURCE_DIR}/transcoder/basisu_transcoder.cpp
+     ${basisu_SOURCE_DIR}/zstd/zstddeclib.c
+)
+
+target_include_directories(BasisTranscoder PUBLIC ${basisu_SOURCE_DIR}/transcoder)
+
+target_compile_definitions(BasisTranscoder PUBLIC BASISD_SUPPORT_KTX2=1 BASISD_SUPPORT_KTX2_ZSTD=1)
+
+set_property(TARGET BasisTranscoder PROPERTY FOLDER "extern/basisu")
@@ -0,0 +1,11 @@
+CPMAddPackage(
+  NAME draco
+  GITHUB_REPOSITORY google/draco
+  GIT_TAG 1.5.7
+  OPTIONS "DRACO_GLTF_BITSTREAM ON" "DRACO_TESTS OFF" "DRACO_JS_GLUE OFF"
+)
+
+# decoder only, draco_features.h is generated into the build tree
+target_include_directories(draco INTERFACE ${draco_SOURCE_DIR}/src ${draco_BINARY_DIR})
+
+set_property(TARGET draco draco_decoder draco_encoder PROPERTY FOLDER "extern/draco")
@@ -0,0 +1,7 @@
+CPMAddPackage(
+  NAME meshoptimizer
+  GITHUB_REPOSITORY zeux/meshoptimizer
+  GIT_TAG v0.22
+)
+
+set_property(TARGET meshoptimizer PROPERTY FOLDER "extern/meshoptimizer")
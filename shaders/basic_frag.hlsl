@@ -37,6 +37,9 @@ StageOutput main(StageInput stageInput)
     float bias = 0.001f;
     float shadow = (currentDepth - bias) > depthFromShadowMap ? 1.0f : 0.0f;
     
-    stageOutput.outFragColor = float4(albedo.rgb * (1.0f - shadow + 0.2f), albedo.a);
+    // albedo is sampled linear, the render target is not sRGB
+    float3 color = pow(albedo.rgb * (1.0f - shadow + 0.2f), 1.0 / 2.2);
+
+    stageOutput.outFragColor = float4(color, albedo.a);
     return stageOutput;
 }
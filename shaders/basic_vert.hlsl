@@ -16,10 +16,9 @@ cbuffer lightViewProjMatrixBuffer : register(b2)
 struct StageInput
 {
     float3 inPos : POSITION;
-    float3 inNormal : NORMAL;
+    float2 inNormal : NORMAL; // octahedral
     float2 inUV : TEXCOORD;
-    float4 inTangent : TANGENT;
-    float3 inBiTangent : BITANGENT;
+    float4 inTangent : TANGENT; // xy octahedral, z handedness
 };
 
 struct StageOutput
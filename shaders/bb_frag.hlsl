@@ -1,7 +1,6 @@
 struct StageInput
 {
     float4 position : SV_Position;
-    float2 inUV : TEXCOORD;
 };
 
 struct StageOutput
@@ -11,16 +11,11 @@ cbuffer modelMatrixBuffer : register(b1)
 struct StageInput
 {
     float3 inPos : POSITION;
-    float3 inNormal : NORMAL;
-    float2 inUV : TEXCOORD;
-    float4 inTangent : TANGENT;
-    float3 inBiTangent : BITANGENT;
 };
 
 struct StageOutput
 {
     float4 position : SV_Position;
-    float2 outUV : TEXCOORD;
 };
 
 StageOutput main(StageInput stageInput)
@@ -30,6 +25,5 @@ StageOutput main(StageInput stageInput)
     float4 worldPos = mul(float4(stageInput.inPos, 1.0f), c_modelMatrix);
     stageOutput.position = mul(worldPos, c_viewProjectionMatrix);
 
-    stageOutput.outUV = stageInput.inUV;
     return stageOutput;
 }
@@ -11,10 +11,6 @@ cbuffer modelMatrixBuffer : register(b1)
 struct StageInput
 {
     float3 inPos : POSITION;
-    float3 inNormal : NORMAL;
-    float2 inUV : TEXCOORD;
-    float4 inTangent : TANGENT;
-    float3 inBiTangent : BITANGENT;
 };
 
 struct StageOutput
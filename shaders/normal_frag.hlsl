@@ -42,8 +42,9 @@ StageOutput main(StageInput stageInput)
     
     float4 texColor = albedoTexture.Sample(mySampler, stageInput.inUV);
     
-    float3 tangentNormal = normalTexture.Sample(mySampler, stageInput.inUV).rgb;
-    tangentNormal = normalize(tangentNormal * 2.0f - 1.0f);
+    // only xy are used, BC5 normal maps have no z. z is rebuilt from the unit length
+    float2 tangentNormalXY = normalTexture.Sample(mySampler, stageInput.inUV).rg * 2.0f - 1.0f;
+    float3 tangentNormal = float3(tangentNormalXY, sqrt(saturate(1.0f - dot(tangentNormalXY, tangentNormalXY))));
     
     float3 N = normalize(stageInput.inNormal);
     float3 T = normalize(stageInput.inTangent.xyz);
@@ -59,6 +60,7 @@ StageOutput main(StageInput stageInput)
 
     float3 finalColor = texColor.rgb * lightColor * NdotL;
 
-    output.outFragColor = float4(finalColor, texColor.a);
+    // albedo is sampled linear, the render target is not sRGB
+    output.outFragColor = float4(pow(finalColor, 1.0 / 2.2), texColor.a);
     return output;
 }
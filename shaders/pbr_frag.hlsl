@@ -1,9 +1,8 @@
 // Texture and sampler bound from root signature
 Texture2D albedoTexture             : register(t0);
-Texture2D metallicRoughnessTexture  : register(t1);
+Texture2D ormTexture                : register(t1); // R occlusion, G roughness, B metallic
 Texture2D normalTexture             : register(t2);
 Texture2D emissiveTexture           : register(t3);
-Texture2D occlusionTexture          : register(t4);
 
 SamplerState mySampler              : register(s0);
 
@@ -88,19 +87,21 @@ StageOutput main(StageInput stageInput)
 {
     StageOutput stageOutput;
     
-    float4 albedoalpha = pow(albedoTexture.Sample(mySampler, stageInput.inUV), 2.2);
+    // sRGB texture, sampled linear
+    float4 albedoalpha = albedoTexture.Sample(mySampler, stageInput.inUV);
     albedoalpha *= c_baseColorFactor;
     float3 albedo = albedoalpha.rgb;
 
-    float4 mr = metallicRoughnessTexture.Sample(mySampler, stageInput.inUV);
-    float metallic = mr.b * c_metallicFactor; 
-    float roughness = mr.g * c_roughnessFactor;
+    float3 orm = ormTexture.Sample(mySampler, stageInput.inUV).rgb;
+    float ao = orm.r;
+    float roughness = orm.g * c_roughnessFactor;
+    float metallic = orm.b * c_metallicFactor;
 
     float3 emissive = emissiveTexture.Sample(mySampler, stageInput.inUV).rgb;
-    float ao = occlusionTexture.Sample(mySampler, stageInput.inUV).r;
     
-    float3 tangentNormal = normalTexture.Sample(mySampler, stageInput.inUV).rgb;
-    tangentNormal = normalize(tangentNormal * 2.0f - 1.0f); 
+    // only xy are used, BC5 normal maps have no z. z is rebuilt from the unit length
+    float2 tangentNormalXY = normalTexture.Sample(mySampler, stageInput.inUV).rg * 2.0f - 1.0f;
+    float3 tangentNormal = float3(tangentNormalXY, sqrt(saturate(1.0f - dot(tangentNormalXY, tangentNormalXY))));
     
     float3 N = normalize(stageInput.inNormal);
     float3 T = normalize(stageInput.inTangent.xyz);
@@ -11,10 +11,9 @@ cbuffer modelMatrixBuffer : register(b1)
 struct StageInput
 {
     float3 inPos : POSITION;
-    float3 inNormal : NORMAL;
+    float2 inNormal : NORMAL; // octahedral
     float2 inUV : TEXCOORD;
-    float4 inTangent : TANGENT;
-    float3 inBiTangent : BITANGENT;
+    float4 inTangent : TANGENT; // xy octahedral, z handedness
 };
 
 struct StageOutput
@@ -27,6 +26,15 @@ struct StageOutput
     float3 outBiTangent : BITANGENT;
 };
 
+float3 DecodeOctahedral(float2 encoded)
+{
+    float3 direction = float3(encoded.x, encoded.y, 1.0f - abs(encoded.x) - abs(encoded.y));
+    float t = saturate(-direction.z);
+    direction.x += direction.x >= 0.0f ? -t : t;
+    direction.y += direction.y >= 0.0f ? -t : t;
+    return normalize(direction);
+}
+
 StageOutput main(StageInput stageInput)
 {
     StageOutput output;
@@ -36,12 +44,17 @@ StageOutput main(StageInput stageInput)
     
     output.outPosition = mul(worldPos, c_viewProjectionMatrix);
     
-    output.outNormal = normalize(mul(float4(stageInput.inNormal, 0.0f), c_modelMatrix).xyz);
+    float3 normal = DecodeOctahedral(stageInput.inNormal);
+    float3 tangent = DecodeOctahedral(stageInput.inTangent.xy);
+    float handedness = stageInput.inTangent.z < 0.0f ? -1.0f : 1.0f;
+
+    output.outNormal = normalize(mul(float4(normal, 0.0f), c_modelMatrix).xyz);
     
-    float3 tangentWorld = normalize(mul(float4(stageInput.inTangent.xyz, 0.0f), c_modelMatrix).xyz);
-    output.outTangent = float4(tangentWorld, stageInput.inTangent.w);
+    float3 tangentWorld = normalize(mul(float4(tangent, 0.0f), c_modelMatrix).xyz);
+    output.outTangent = float4(tangentWorld, handedness);
     
-    output.outBiTangent = normalize(mul(float4(stageInput.inBiTangent.xyz, 0.0f), c_modelMatrix).xyz);
+    // not stored in the vertex buffer anymore
+    output.outBiTangent = normalize(mul(float4(cross(normal, tangent) * handedness, 0.0f), c_modelMatrix).xyz);
 
     output.outUV = stageInput.inUV;
 
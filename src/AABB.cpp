@@ -1,11 +1,11 @@
 #include "AABB.h"
 
-AABB::AABB(const std::vector<Vertex>& vertices)
+AABB::AABB(std::span<const Vertex> vertices)
 {
 	ComputeFromVertices(vertices);
 }
 
-void AABB::ComputeFromVertices(const std::vector<Vertex>& vertices)
+void AABB::ComputeFromVertices(std::span<const Vertex> vertices)
 {
 	XMFLOAT3 min = vertices[0].position;
 	XMFLOAT3 max = vertices[0].position;
@@ -25,14 +25,14 @@ void AABB::ComputeFromVertices(const std::vector<Vertex>& vertices)
 	_max = max;
 
 	_aabbVertices = {
-			{{_min.x, _min.y, _min.z}, {0, 1, 0}, {0, 0}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_min.x, _max.y, _min.z}, {0, 1, 0}, {1, 1}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_min.x, _min.y, _max.z}, {0, 1, 0}, {0, 1}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_min.x, _max.y, _max.z}, {0, 1, 0}, {1, 0}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_max.x, _min.y, _min.z}, {0, 1, 0}, {0, 0}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_max.x, _max.y, _min.z}, {0, 1, 0}, {1, 1}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_max.x, _min.y, _max.z}, {0, 1, 0}, {0, 1}, {1, 0, 0, 1}, {1, 0, 0}},
-			{{_max.x, _max.y, _max.z}, {0, 1, 0}, {1, 0}, {1, 0, 0, 1}, {1, 0, 0}}
+			{{_min.x, _min.y, _min.z}, {0, 1, 0}, {0, 0}, {1, 0, 0, 1}},
+			{{_min.x, _max.y, _min.z}, {0, 1, 0}, {1, 1}, {1, 0, 0, 1}},
+			{{_min.x, _min.y, _max.z}, {0, 1, 0}, {0, 1}, {1, 0, 0, 1}},
+			{{_min.x, _max.y, _max.z}, {0, 1, 0}, {1, 0}, {1, 0, 0, 1}},
+			{{_max.x, _min.y, _min.z}, {0, 1, 0}, {0, 0}, {1, 0, 0, 1}},
+			{{_max.x, _max.y, _min.z}, {0, 1, 0}, {1, 1}, {1, 0, 0, 1}},
+			{{_max.x, _min.y, _max.z}, {0, 1, 0}, {0, 1}, {1, 0, 0, 1}},
+			{{_max.x, _max.y, _max.z}, {0, 1, 0}, {1, 0}, {1, 0, 0, 1}}
 	};
 
 	_aabbIndices = {
@@ -44,7 +44,8 @@ void AABB::ComputeFromVertices(const std::vector<Vertex>& vertices)
 		2, 3, 6, 3, 7, 6  
 	};
 
-	auto vertexBufferSize = _aabbVertices.size() * sizeof(Vertex);
+	// the bounding box pass only reads positions
+	auto vertexBufferSize = _aabbVertices.size() * VertexFormat::PositionStream::stride;
 	_vertexBuffer = CreateBuffer(vertexBufferSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
 
 	_indicesSize = static_cast<uint32_t>(_aabbIndices.size());
@@ -55,7 +56,7 @@ void AABB::ComputeFromVertices(const std::vector<Vertex>& vertices)
 
 	_vertexBufferView.BufferLocation = _vertexBuffer->GetGPUVirtualAddress();
 	_vertexBufferView.SizeInBytes = static_cast<uint32_t>(vertexBufferSize);
-	_vertexBufferView.StrideInBytes = sizeof(Vertex);
+	_vertexBufferView.StrideInBytes = VertexFormat::PositionStream::stride;
 
 	_indexBufferView.BufferLocation = _indexBuffer->GetGPUVirtualAddress();
 	_indexBufferView.SizeInBytes = static_cast<uint32_t>(indexBufferSize);
@@ -143,8 +144,7 @@ void AABB::UploadBuffers()
 	// Map vertex buffer and copy data
 	void* mappedData = nullptr;
 	_vertexBuffer->Map(0, nullptr, &mappedData);
-	auto vertexBufferSize = _aabbVertices.size() * sizeof(Vertex);
-	memcpy(mappedData, _aabbVertices.data(), vertexBufferSize);
+	VertexFormat::PositionStream::PackVertices(_aabbVertices, static_cast<uint8_t*>(mappedData));
 	_vertexBuffer->Unmap(0, nullptr);
 
 	// Map index buffer and copy data
@@ -168,7 +168,7 @@ const XMFLOAT3& AABB::GetMax() const
 
 void AABB::BindMeshData(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
 {
-	commandList->IASetVertexBuffers(0, 1, &_vertexBufferView);
+	commandList->IASetVertexBuffers(VertexFormat::STREAM_POSITION, 1, &_vertexBufferView);
 	commandList->IASetIndexBuffer(&_indexBufferView);
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	commandList->DrawIndexedInstanced(_indicesSize, 1, 0, 0, 0);
@@ -3,14 +3,15 @@
 #include "pch.h"
 
 #include "D3D12Core.h"
+#include "VertexFormat.h"
 
 class AABB
 {
 public:
 	AABB() = default;
-	AABB(const std::vector<Vertex>& vertices);
+	AABB(std::span<const Vertex> vertices);
 
-	void ComputeFromVertices(const std::vector<Vertex>& vertices);
+	void ComputeFromVertices(std::span<const Vertex> vertices);
 	void Recompute(const XMFLOAT4X4& matrix);
 
 	MSWRL::ComPtr<ID3D12Resource> CreateBuffer(uint64_t size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState);
@@ -37,6 +37,9 @@ void Application::InitializeApplication()
 	D3D12Core::GraphicsDevice::IntializeDebugDevice();
 #endif
 
+	JobSystem::InitializeJobSystem();
+	ImportArena::InstallMeshoptAllocator();
+
 	_renderer.InitializeRenderer();
 
 	D3D12Core::Swapchain::InitializeSwapchain();
@@ -84,6 +87,7 @@ void Application::Run()
 
 	_renderer.Shutdown();
 	GUI::Shutdown();
+	JobSystem::Shutdown();
 }
 
 void Application::Update(float dt)
@@ -14,6 +14,8 @@
 #include "Camera.h"
 #include "DirectionalLight.h"
 #include "PointLight.h"
+#include "JobSystem.h"
+#include "ImportArena.h"
 
 class Application
 {
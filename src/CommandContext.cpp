@@ -1,5 +1,12 @@
 #include "CommandContext.h"
 
+namespace
+{
+	// {5B0E6C9A-3D41-4F8E-9A27-C1D84E2B7F63}
+	constexpr GUID recordingIdGuid = { 0x5b0e6c9a, 0x3d41, 0x4f8e, { 0x9a, 0x27, 0xc1, 0xd8, 0x4e, 0x2b, 0x7f, 0x63 } };
+	std::atomic<uint64_t> recordingIdIncrementor = 1;
+}
+
 void CommandContext::InitializeCommandContext(QUEUETYPE queueType)
 {
 	_queueType = queueType;
@@ -32,6 +39,8 @@ void CommandContext::InitializeCommandContext(QUEUETYPE queueType)
 	_allocator->SetName(allocatorName.c_str());
 	ThrowIfFailed(D3D12Core::GraphicsDevice::device->CreateCommandList(0, listType, _allocator.Get(), nullptr, IID_PPV_ARGS(&_commandList)), "Failed to create CommandList!");
 	_commandList->SetName(listName.c_str());
+
+	BeginRecording();
 }
 
 void CommandContext::SetPipelineState(MSWRL::ComPtr<ID3D12PipelineState> pipelineState)
@@ -43,15 +52,37 @@ void CommandContext::Reset()
 {
 	ThrowIfFailed(_allocator->Reset(), "Failed to reset Allocator!");
 	ThrowIfFailed(_commandList->Reset(_allocator.Get(), nullptr), "Failed to reset CommandList!");
+
+	BeginRecording();
 }
 
-void CommandContext::Finish(bool waitForExecution)
+uint64_t CommandContext::GetRecordingId(ID3D12GraphicsCommandList* commandList)
+{
+	uint64_t recordingId = 0;
+	UINT size = sizeof(recordingId);
+	if (FAILED(commandList->GetPrivateData(recordingIdGuid, &size, &recordingId)))
+		return 0;
+	return recordingId;
+}
+
+void CommandContext::BeginRecording()
+{
+	_recordingId = recordingIdIncrementor++;
+	ThrowIfFailed(_commandList->SetPrivateData(recordingIdGuid, sizeof(_recordingId), &_recordingId));
+}
+
+uint64_t CommandContext::Finish(bool waitForExecution)
 {
 	_commandList->Close();
 
+	CommandQueue& commandQueue = CommandQueueManager::GetCommandQueue(_queueType);
+
 	ID3D12CommandList* cmdLists[] = { _commandList.Get() };
-	CommandQueueManager::GetCommandQueue(_queueType)._commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
+	commandQueue._commandQueue->ExecuteCommandLists(_countof(cmdLists), cmdLists);
 
+	uint64_t fenceValue = commandQueue.Signal();
 	if (waitForExecution)
-		CommandQueueManager::GetCommandQueue(_queueType).WaitForFence();
+		commandQueue.WaitForFenceValue(fenceValue);
+
+	return fenceValue;
 }
\ No newline at end of file
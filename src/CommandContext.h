@@ -2,6 +2,8 @@
 
 #include "pch.h"
 
+#include <atomic>
+
 #include "D3D12Core.h"
 #include "CommandQueue.h"
 
@@ -18,9 +20,18 @@ public:
 
 	MSWRL::ComPtr<ID3D12GraphicsCommandList> GetCommandList() { return _commandList.Get(); }
 
-	void Finish(bool waitForExecution);
+	// returns the queue fence value that marks the end of this command list
+	uint64_t Finish(bool waitForExecution);
+
+	// unique per recording (Initialize/Reset), unlike the list address it is never reused. Stored on the list so
+	// whatever records into it (e.g. Texture) can find it
+	uint64_t GetRecordingId() const { return _recordingId; }
+	static uint64_t GetRecordingId(ID3D12GraphicsCommandList* commandList);
 
 private:
+	void BeginRecording();
+
+	uint64_t _recordingId = 0;
 	QUEUETYPE _queueType = QUEUE_INVALID;
 
 	MSWRL::ComPtr<ID3D12CommandAllocator> _allocator;
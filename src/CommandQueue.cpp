@@ -8,24 +8,31 @@ void CommandQueue::InitializeCommandQueue(D3D12_COMMAND_LIST_TYPE queuetype)
 	ThrowIfFailed(D3D12Core::GraphicsDevice::device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&_commandQueue)), "CommandQueue creation failed!");
 
 	ThrowIfFailed(D3D12Core::GraphicsDevice::device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&_fence)));
-
-	_fenceEvent = CreateEvent(nullptr, false, false, nullptr);
-	if (_fenceEvent == nullptr)
-	{
-		ThrowIfFailed(HRESULT_FROM_WIN32(GetLastError()));
-	}
 }
 
 void CommandQueue::WaitForFence()
 {
+	WaitForFenceValue(Signal());
+}
+
+uint64_t CommandQueue::Signal()
+{
+	std::lock_guard<std::mutex> lock(_fenceMutex);
 	_fenceValue++;
-	_commandQueue->Signal(_fence.Get(), _fenceValue);
-	const uint64_t fence = _fenceValue;
-	if (_fence->GetCompletedValue() < fence)
-	{
-		ThrowIfFailed(_fence->SetEventOnCompletion(fence, _fenceEvent));
-		WaitForSingleObjectEx(_fenceEvent, INFINITE, false);
-	}
+	ThrowIfFailed(_commandQueue->Signal(_fence.Get(), _fenceValue));
+	return _fenceValue;
+}
+
+bool CommandQueue::IsFenceComplete(uint64_t fenceValue)
+{
+	return _fence->GetCompletedValue() >= fenceValue;
+}
+
+void CommandQueue::WaitForFenceValue(uint64_t fenceValue)
+{
+	// no event -> blocks until the value is reached, safe to call from several threads at once
+	if (!IsFenceComplete(fenceValue))
+		ThrowIfFailed(_fence->SetEventOnCompletion(fenceValue, nullptr));
 }
 
 namespace CommandQueueManager
@@ -3,6 +3,8 @@
 #include "pch.h"
 #include "D3D12Core.h"
 
+#include <mutex>
+
 enum QUEUETYPE : int32_t
 {
 	QUEUE_INVALID = NOTOK,
@@ -18,11 +20,16 @@ public:
 
 	void WaitForFence();
 
+	// queues may be fed from several threads (background model loads), fence values stay monotonic
+	uint64_t Signal();
+	bool IsFenceComplete(uint64_t fenceValue);
+	void WaitForFenceValue(uint64_t fenceValue);
+
 	MSWRL::ComPtr<ID3D12CommandQueue> _commandQueue;
 	MSWRL::ComPtr<ID3D12Fence> _fence;
 
-	HANDLE _fenceEvent;
 	uint64_t _fenceValue = 0;
+	std::mutex _fenceMutex;
 };
 
 namespace CommandQueueManager
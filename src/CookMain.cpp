@@ -0,0 +1,6 @@
+#include "Cooker.h"
+
+int main(int argc, char** argv)
+{
+	return Cooker::Run(argc, argv);
+}
@@ -0,0 +1,205 @@
+#include "Cooker.h"
+
+#include <cmath>
+
+namespace Cooker
+{
+	// the whole argument has to be a finite, non negative number
+	bool ParseEpsilon(const char* argument, float& value)
+	{
+		char* end = nullptr;
+		value = std::strtof(argument, &end);
+		return end != argument && *end == '\0' && std::isfinite(value) && value >= 0.0f;
+	}
+
+	int Run(int argc, char** argv)
+	{
+		printToConsole = true;
+
+		std::filesystem::path outputDirectory;
+		std::filesystem::path reportPath;
+		std::vector<std::filesystem::path> inputs;
+		bool selfTest = false;
+		bool benchmark = false;
+
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			if ((argument == "-o" || argument == "--output") && i + 1 < argc)
+				outputDirectory = argv[++i];
+			else if (argument == "--report" && i + 1 < argc)
+				reportPath = argv[++i];
+			else if (argument == "--weld-epsilon")
+			{
+				if (i + 2 >= argc || !ParseEpsilon(argv[i + 1], MeshProcessing::weldPositionEpsilon) || !ParseEpsilon(argv[i + 2], MeshProcessing::weldAttributeEpsilon))
+				{
+					PRINT_ERROR("--weld-epsilon takes two non negative numbers");
+					PrintUsage();
+					return 1;
+				}
+				i += 2;
+			}
+			else if (argument == "--self-test")
+				selfTest = true;
+			else if (argument == "--bench")
+				benchmark = true;
+			else if (argument == "-h" || argument == "--help")
+			{
+				PrintUsage();
+				return 0;
+			}
+			else
+				inputs.emplace_back(argument);
+		}
+
+		if (inputs.empty() && !selfTest && !benchmark)
+		{
+			PrintUsage();
+			return 1;
+		}
+
+#if defined(_WIN32)
+		// WIC fallback decoding also runs on the calling thread (it helps out in ParallelFor)
+		ThrowIfFailed(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+#endif
+		JobSystem::InitializeJobSystem();
+		ImportArena::InstallMeshoptAllocator();
+
+		if (selfTest || benchmark)
+		{
+			int result = 0;
+			try
+			{
+				if (selfTest)
+					RunSelfTests();
+				if (benchmark)
+					RunBenchmarks(inputs);
+			}
+			catch (const std::exception& exception)
+			{
+				PRINT_ERROR(exception.what());
+				result = 1;
+			}
+
+			JobSystem::Shutdown();
+#if defined(_WIN32)
+			CoUninitialize();
+#endif
+			return result;
+		}
+
+		uint32_t failed = 0;
+		std::vector<ImportReport::AssetReport> reports(inputs.size());
+		for (size_t inputIndex = 0; inputIndex < inputs.size(); ++inputIndex)
+		{
+			const std::filesystem::path& input = inputs[inputIndex];
+			try
+			{
+				if (!CookModel(input, GetPackagePath(input, outputDirectory), &reports[inputIndex]))
+					failed++;
+			}
+			catch (const std::exception& exception)
+			{
+				PRINT_ERROR("Cooking ", input.string(), " failed: ", exception.what());
+				failed++;
+			}
+		}
+
+		JobSystem::Shutdown();
+#if defined(_WIN32)
+		CoUninitialize();
+#endif
+
+		if (!reportPath.empty())
+		{
+			if (ImportReport::WriteJson(reports, reportPath))
+				PRINT("Import report written to ", reportPath.string());
+			else
+				PRINT_ERROR("Failed to write import report ", reportPath.string());
+		}
+
+		if (failed > 0)
+			PRINT_ERROR("Cooked ", inputs.size() - failed, "/", inputs.size(), " models");
+		else
+			PRINT("Cooked ", inputs.size(), "/", inputs.size(), " models");
+		return failed == 0 ? 0 : 1;
+	}
+
+	bool CookModel(const std::filesystem::path& input, const std::filesystem::path& output, ImportReport::AssetReport* report)
+	{
+		Utils::Timer::StartTimer();
+
+		ImportReport::Recorder recorder;
+		recorder._name = input.filename().string();
+		recorder._source = "import";
+
+		ModelData modelData;
+		bool imported = GLTFLoader::ImportModelData(input, modelData, nullptr, &recorder);
+		if (report)
+			*report = recorder.GetReport(imported);
+		if (!imported)
+		{
+			PRINT_ERROR("Failed to import ", input.string());
+			return false;
+		}
+
+		double importMs = Utils::Timer::GetElapsedMilliseconds();
+
+		uint64_t writtenBytes = 0;
+		if (!GLTFLoader::WriteModelPackage(modelData, output, &writtenBytes))
+		{
+			PRINT_ERROR("Failed to write ", output.string());
+			return false;
+		}
+
+		size_t primitiveCount = 0;
+		size_t vertexCount = 0;
+		for (const std::vector<PrimitiveData>& mesh : modelData.meshes)
+		{
+			primitiveCount += mesh.size();
+			for (const PrimitiveData& primitive : mesh)
+				vertexCount += primitive.vertices.size();
+		}
+
+		PRINT(input.filename().string(), " -> ", output.string());
+		PRINT("  primitives: ", primitiveCount, " | vertices: ", vertexCount, " | materials: ", modelData.materials.size(), " | textures: ", modelData.textures.size(), " | nodes: ", modelData.nodes.size());
+		PRINT("  import: ", importMs, "ms | total: ", Utils::Timer::GetElapsedMilliseconds(), "ms | package: ", writtenBytes / 1024, "KB");
+		if (report)
+			ImportReport::Print(*report);
+
+		return true;
+	}
+
+	void RunSelfTests()
+	{
+		MeshProcessing::TestMeshletBounds();
+		PRINT("Self test passed");
+	}
+
+	void RunBenchmarks(std::span<const std::filesystem::path> models)
+	{
+		MeshProcessing::BenchmarkTangentGeneration(4000000);
+		TextureProcessing::BenchmarkMipGeneration(4096, 8);
+
+		for (const std::filesystem::path& model : models)
+		{
+			GLTFLoader::BenchmarkGeometryExtraction(model, 256);
+			GLTFLoader::BenchmarkAccessorExtraction(model, 16);
+		}
+	}
+
+	std::filesystem::path GetPackagePath(const std::filesystem::path& input, const std::filesystem::path& outputDirectory)
+	{
+		std::filesystem::path output = outputDirectory.empty() ? input.parent_path() : outputDirectory;
+		return output / input.filename().replace_extension(ModelPackage::PACKAGE_EXTENSION);
+	}
+
+	void PrintUsage()
+	{
+		PRINT("usage: artisDX-cook [-o <outputDirectory>] [--report <report.json>] [--weld-epsilon <position> <attribute>] <model.glb|model.gltf>...");
+		PRINT("       artisDX-cook --self-test");
+		PRINT("       artisDX-cook --bench [<model.glb|model.gltf>...]");
+		PRINT("  writes one ", ModelPackage::PACKAGE_EXTENSION, " package per model, load it with ModelManager::LoadModel");
+		PRINT("  --self-test checks the meshlet bounds on synthetic meshes, --bench times the import stages (the geometry ones on the models given)");
+	}
+}
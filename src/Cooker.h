@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pch.h"
+
+#include "GLTFLoader.h"
+#include "JobSystem.h"
+#include "ImportArena.h"
+
+// headless side of the import pipeline: runs the CPU stages of GLTFLoader and writes a package, needs no GPU
+namespace Cooker
+{
+	// artisDX-cook [-o <outputDirectory>] [--report <report.json>] [--weld-epsilon <position> <attribute>] <model.glb|model.gltf>...
+	// artisDX-cook --self-test | --bench [<model.glb|model.gltf>...]
+	// progress goes to stdout, failures to stderr
+	int Run(int argc, char** argv);
+
+	// checks that need no asset, throws on the first failure
+	void RunSelfTests();
+	// the CPU stage benchmarks, the geometry ones run on every model given
+	void RunBenchmarks(std::span<const std::filesystem::path> models);
+
+	// with a report the import stages of the model are timed into it
+	bool CookModel(const std::filesystem::path& input, const std::filesystem::path& output, ImportReport::AssetReport* report = nullptr);
+	std::filesystem::path GetPackagePath(const std::filesystem::path& input, const std::filesystem::path& outputDirectory);
+	void PrintUsage();
+}
@@ -0,0 +1,238 @@
+#include "DerivedDataCache.h"
+
+#include "GLTFLoader.h"
+
+namespace DerivedDataCache
+{
+	bool enabled = true;
+	std::filesystem::path cacheDirectory = "../cache";
+	uint64_t maxCacheSize = 2ull * 1024 * 1024 * 1024;
+	Statistics statistics;
+	std::mutex cacheMutex;
+
+	std::string ToHex(uint64_t value)
+	{
+		char buffer[17];
+		snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+		return buffer;
+	}
+
+	bool IsCacheEntry(const std::filesystem::path& path)
+	{
+		return path.extension() == ".model" || path.extension() == ".texture";
+	}
+
+	void TouchEntry(const std::filesystem::path& path)
+	{
+		std::error_code errorCode;
+		std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), errorCode);
+	}
+
+	void EvictEntries()
+	{
+		struct Entry
+		{
+			std::filesystem::path path;
+			uint64_t size;
+			std::filesystem::file_time_type lastUse;
+		};
+
+		std::error_code errorCode;
+		std::vector<Entry> entries;
+		uint64_t totalSize = 0;
+
+		for (const std::filesystem::directory_entry& directoryEntry : std::filesystem::directory_iterator(DerivedDataCache::cacheDirectory, errorCode))
+		{
+			if (!directoryEntry.is_regular_file(errorCode) || !IsCacheEntry(directoryEntry.path()))
+				continue;
+
+			Entry& entry = entries.emplace_back();
+			entry.path = directoryEntry.path();
+			entry.size = directoryEntry.file_size(errorCode);
+			entry.lastUse = directoryEntry.last_write_time(errorCode);
+			totalSize += entry.size;
+		}
+
+		if (totalSize <= DerivedDataCache::maxCacheSize)
+			return;
+
+		std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+
+		for (const Entry& entry : entries)
+		{
+			if (totalSize <= DerivedDataCache::maxCacheSize)
+				break;
+
+			// entries that are mapped right now can not be removed, they just stay until the next pass
+			if (!std::filesystem::remove(entry.path, errorCode) || errorCode)
+				continue;
+
+			totalSize -= entry.size;
+			DerivedDataCache::statistics.evictions++;
+			DerivedDataCache::statistics.evictedBytes += entry.size;
+		}
+	}
+
+	bool OpenEntry(const std::filesystem::path& path, PackageReader& reader)
+	{
+		TouchEntry(path);
+
+		if (!reader.Open(path, DerivedDataCache::PROCESSING_VERSION))
+			return false;
+
+		DerivedDataCache::statistics.bytesMapped += reader.GetFileSize();
+		return true;
+	}
+
+	uint64_t HashSourceFile(const std::filesystem::path& path)
+	{
+		MappedFile file;
+		if (!file.Open(path))
+			return 0;
+
+		uint64_t hash = Utils::HashBytes(file.GetData(), file.GetSize());
+
+		// .gltf references buffers and images by uri, hashing their size + write time is enough to notice edits.
+		// Only the files the asset references count, unrelated files next to it do not invalidate the entry
+		if (Utils::HasExtension(path, ".gltf"))
+		{
+			auto data = fastgltf::GltfDataBuffer::FromBytes(reinterpret_cast<const std::byte*>(file.GetData()), file.GetSize());
+			if (!bool(data))
+				return 0;
+
+			// just the JSON of buffers and images, nothing is loaded. An asset that does not parse is not cached
+			auto asset = GLTFLoader::parser.loadGltf(data.get(), path.parent_path(), fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble,
+				fastgltf::Category::Buffers | fastgltf::Category::Images);
+			if (asset.error() != fastgltf::Error::None)
+				return 0;
+
+			std::vector<std::filesystem::path> references;
+			auto addReference = [&](const fastgltf::DataSource& source)
+			{
+				if (auto uriPtr = std::get_if<fastgltf::sources::URI>(&source); uriPtr && uriPtr->uri.isLocalPath())
+					references.push_back(uriPtr->uri.fspath().lexically_normal());
+			};
+			for (const fastgltf::Buffer& buffer : asset->buffers)
+				addReference(buffer.data);
+			for (const fastgltf::Image& image : asset->images)
+				addReference(image.data);
+
+			std::sort(references.begin(), references.end());
+			references.erase(std::unique(references.begin(), references.end()), references.end());
+
+			std::error_code errorCode;
+			for (const std::filesystem::path& reference : references)
+			{
+				const std::filesystem::path referencePath = path.parent_path() / reference;
+				std::string name = reference.generic_string();
+				uint64_t stamp[2] = {
+					std::filesystem::file_size(referencePath, errorCode),
+					static_cast<uint64_t>(std::filesystem::last_write_time(referencePath, errorCode).time_since_epoch().count())
+				};
+
+				hash = Utils::HashBytes(name.data(), name.size(), hash);
+				hash = Utils::HashBytes(stamp, sizeof(stamp), hash);
+			}
+		}
+
+		// 0 means "not cacheable"
+		return hash == 0 ? 1 : hash;
+	}
+
+	bool FindModel(uint64_t sourceHash, PackageReader& reader)
+	{
+		std::lock_guard<std::mutex> lock(DerivedDataCache::cacheMutex);
+
+		bool hit = OpenEntry(GetModelEntryPath(sourceHash), reader);
+		hit ? DerivedDataCache::statistics.modelHits++ : DerivedDataCache::statistics.modelMisses++;
+		return hit;
+	}
+
+	bool FindTexture(uint64_t contentHash, Texture::TEXTURETYPE texType, PackageReader& reader)
+	{
+		std::lock_guard<std::mutex> lock(DerivedDataCache::cacheMutex);
+
+		bool hit = OpenEntry(GetTextureEntryPath(contentHash, texType), reader);
+		hit ? DerivedDataCache::statistics.textureHits++ : DerivedDataCache::statistics.textureMisses++;
+		return hit;
+	}
+
+	void StoreModel(uint64_t sourceHash, const ModelData& modelData)
+	{
+		// written without the lock, lookups of other loads go on meanwhile. WriteToFile renames a complete temp file into
+		// place, a reader sees the whole entry or none
+		uint64_t bytesWritten = 0;
+		uint64_t entriesWritten = 0;
+		auto writeEntry = [&](const PackageWriter& writer, const std::filesystem::path& path)
+		{
+			uint64_t writtenBytes = 0;
+			if (!writer.WriteToFile(path, DerivedDataCache::PROCESSING_VERSION, &writtenBytes))
+			{
+				// a concurrent load stored the same entry (and may have it mapped already)
+				std::error_code errorCode;
+				if (!std::filesystem::exists(path, errorCode))
+					PRINT("DerivedDataCache: failed to write ", path.string());
+				return false;
+			}
+
+			bytesWritten += writtenBytes;
+			entriesWritten++;
+			return true;
+		};
+
+		// textures first, a model entry is only useful if its textures can be found as well
+		for (const TextureJob& textureJob : modelData.textures)
+		{
+			if (!textureJob.imageIndex.has_value() || textureJob.sourceJobIndex != NOTOK || textureJob.scratchImage.GetImageCount() == 0)
+				continue;
+
+			std::filesystem::path path = GetTextureEntryPath(textureJob.contentHash, textureJob.textureType);
+
+			std::error_code errorCode;
+			if (std::filesystem::exists(path, errorCode))
+				continue;
+
+			PackageWriter writer;
+			ModelPackage::WriteTexture(writer, 0, textureJob.scratchImage);
+			writeEntry(writer, path);
+		}
+
+		PackageWriter writer;
+		ModelPackage::WriteModel(writer, modelData);
+		writeEntry(writer, GetModelEntryPath(sourceHash));
+
+		std::lock_guard<std::mutex> lock(DerivedDataCache::cacheMutex);
+		DerivedDataCache::statistics.bytesWritten += bytesWritten;
+		DerivedDataCache::statistics.entriesWritten += entriesWritten;
+		EvictEntries();
+	}
+
+	void EnforceSizeLimit()
+	{
+		std::lock_guard<std::mutex> lock(DerivedDataCache::cacheMutex);
+		EvictEntries();
+	}
+
+	Statistics GetStatistics()
+	{
+		std::lock_guard<std::mutex> lock(DerivedDataCache::cacheMutex);
+		return DerivedDataCache::statistics;
+	}
+
+	void PrintStatistics()
+	{
+		Statistics stats = GetStatistics();
+		PRINT("DerivedDataCache: models ", stats.modelHits, " hits / ", stats.modelMisses, " misses | textures ", stats.textureHits, " hits / ", stats.textureMisses, " misses");
+		PRINT("  mapped: ", stats.bytesMapped / 1024, "KB | written: ", stats.bytesWritten / 1024, "KB in ", stats.entriesWritten, " entries | evicted: ", stats.evictions, " entries (", stats.evictedBytes / 1024, "KB)");
+	}
+
+	std::filesystem::path GetModelEntryPath(uint64_t sourceHash)
+	{
+		return DerivedDataCache::cacheDirectory / (ToHex(sourceHash) + "_v" + std::to_string(DerivedDataCache::PROCESSING_VERSION) + ".model");
+	}
+
+	std::filesystem::path GetTextureEntryPath(uint64_t contentHash, Texture::TEXTURETYPE texType)
+	{
+		return DerivedDataCache::cacheDirectory / (ToHex(contentHash) + "_" + std::to_string(static_cast<int32_t>(texType)) + "_v" + std::to_string(DerivedDataCache::PROCESSING_VERSION) + ".texture");
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "pch.h"
+
+#include <mutex>
+
+#include "ModelPackage.h"
+
+// On-disk cache of processed import results (geometry, materials, nodes, mip chains).
+// Entries are keyed by the hash of the source content and PROCESSING_VERSION, so edited sources
+// or a changed pipeline simply miss and old entries age out through the size limit.
+namespace DerivedDataCache
+{
+	// bump whenever the import pipeline produces different output
+	constexpr uint32_t PROCESSING_VERSION = 12;
+
+	struct Statistics
+	{
+		uint64_t modelHits = 0;
+		uint64_t modelMisses = 0;
+		uint64_t textureHits = 0;
+		uint64_t textureMisses = 0;
+		uint64_t bytesMapped = 0;
+		uint64_t bytesWritten = 0;
+		uint64_t entriesWritten = 0;
+		uint64_t evictions = 0;
+		uint64_t evictedBytes = 0;
+	};
+
+	// 0 if the source can not be read (or a .gltf not parsed), .gltf files also fold in the buffers and images they reference
+	uint64_t HashSourceFile(const std::filesystem::path& path);
+
+	bool FindModel(uint64_t sourceHash, PackageReader& reader);
+	bool FindTexture(uint64_t contentHash, Texture::TEXTURETYPE texType, PackageReader& reader);
+
+	// writes the model entry plus one entry per decoded texture, has to run before the scratch images are uploaded
+	void StoreModel(uint64_t sourceHash, const ModelData& modelData);
+
+	// least recently used entries (by last write time, touched on every hit) go first
+	void EnforceSizeLimit();
+
+	Statistics GetStatistics();
+	void PrintStatistics();
+
+	std::filesystem::path GetModelEntryPath(uint64_t sourceHash);
+	std::filesystem::path GetTextureEntryPath(uint64_t contentHash, Texture::TEXTURETYPE texType);
+
+	extern bool enabled;
+	extern std::filesystem::path cacheDirectory;
+	extern uint64_t maxCacheSize;
+	extern Statistics statistics;
+	extern std::mutex cacheMutex;
+}
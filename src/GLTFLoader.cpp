@@ -1,193 +1,542 @@
 #include "GLTFLoader.h"
 
+#include <draco/compression/decode.h>
+
 namespace GLTFLoader
 {
-	fastgltf::Parser parser;
-	int32_t modelIdIncrementor = 0;
+	// KHR_mesh_quantization only widens the accessor types, the accessor tools convert them to the float Vertex
+	// and the attribute stream packs them compact again. Meshopt views and Draco primitives are decoded after parsing
+	thread_local fastgltf::Parser parser(fastgltf::Extensions::EXT_meshopt_compression | fastgltf::Extensions::KHR_draco_mesh_compression
+		| fastgltf::Extensions::KHR_mesh_quantization | fastgltf::Extensions::KHR_texture_basisu);
+	std::atomic<int32_t> modelIdIncrementor = 0;
+	bool parallelExtraction = true;
+	bool progressiveStreaming = true;
+	uint32_t coarseTextureSize = 64;
+	bool releaseStagingCopies = true;
+
+	uint64_t GetGeometryBytes(const std::vector<std::vector<PrimitiveData>>& meshPrimitives)
+	{
+		uint64_t bytes = 0;
+		for (const std::vector<PrimitiveData>& primitives : meshPrimitives)
+			for (const PrimitiveData& data : primitives)
+				bytes += data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(uint32_t);
+		return bytes;
+	}
 
-	bool GLTFLoader::ConstructModelFromFile(const std::filesystem::path& path, std::shared_ptr<Model>& model, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
+	bool GLTFLoader::StreamModelFromFile(const std::filesystem::path& path, const StageCallback& onStage, ImportReport::Recorder* report, UploadBatch* batch)
 	{
-		constexpr auto gltfOptions =
-			fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble
-			| fastgltf::Options::LoadExternalBuffers
-			| fastgltf::Options::LoadExternalImages | fastgltf::Options::DecomposeNodeMatrices
-			| fastgltf::Options::None;
+		if (report)
+			report->_name = path.filename().string();
 
-		auto data = fastgltf::MappedGltfFile::FromPath(path);
-		if (!bool(data)) {
-			std::cerr << "Failed to open glTF file at " << path << ". Error: " << fastgltf::getErrorMessage(data.error()) << '\n';
-			return false;
+		uint64_t sourceHash = DerivedDataCache::enabled ? DerivedDataCache::HashSourceFile(path) : 0;
+
+		// import settings that change the output are part of the key
+		if (sourceHash != 0)
+		{
+			const uint32_t importSettings[] = { TextureProcessing::transcodeBasisu, TextureProcessing::compressTextures, TextureProcessing::bc7Quick, MeshProcessing::weldVertices, MeshProcessing::optimizeMeshes, MeshProcessing::buildMeshlets, MeshProcessing::maxMeshletVertices, MeshProcessing::maxMeshletTriangles,
+				MeshProcessing::generateLods, MeshProcessing::maxLodCount, MeshProcessing::lodMinTriangles };
+			const float floatSettings[] = { MeshProcessing::weldPositionEpsilon, MeshProcessing::weldAttributeEpsilon,
+				MeshProcessing::lodReduction, MeshProcessing::lodTargetError, MeshProcessing::lodNormalWeight, MeshProcessing::lodUVWeight };
+			sourceHash = Utils::HashBytes(importSettings, sizeof(importSettings), sourceHash);
+			sourceHash = Utils::HashBytes(floatSettings, sizeof(floatSettings), sourceHash);
+		}
+		if (sourceHash != 0 && StreamModelFromCache(path, sourceHash, onStage, report, batch))
+		{
+			DerivedDataCache::PrintStatistics();
+			return true;
 		}
 
-		auto asset = GLTFLoader::parser.loadGltf(data.get(), path.parent_path(), gltfOptions);
-		if (auto error = asset.error(); error != fastgltf::Error::None)
+		// the geometry is done long before the textures are decoded, it is shown with the fallbacks in the meantime.
+		// A batch is shown as a whole, an earlier stage would only add a submit per load
+		std::vector<Mesh> meshes;
+		auto streamGeometry = [&](const ModelData& geometry)
 		{
-			// Some error occurred while reading the buffer, parsing the JSON, or validating the data.
-			std::cout << "Error occurred while parsing " << path << '\n';
+			RecordStage("geometry", false, [&](MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
+			{
+				meshes = CreateMeshes(MakePrimitiveViews(geometry.meshes), uploadBytes);
+
+				std::vector<std::shared_ptr<Texture>> textures;
+				for (const TextureJob& textureJob : geometry.textures)
+					textures.push_back(TextureCache::GetFallbackTexture(textureJob.textureType));
+
+				return AssembleModel(geometry.name, meshes, geometry.materials, std::move(textures), geometry.nodes);
+			}, onStage, report);
+		};
+
+		if (report)
+			report->_source = "import";
+
+		ModelData modelData;
+		if (!ImportModelData(path, modelData, GLTFLoader::progressiveStreaming && !batch ? GeometryCallback(streamGeometry) : GeometryCallback(), report))
 			return false;
+
+		// before the upload, which takes the scratch images
+		if (sourceHash != 0)
+		{
+			DerivedDataCache::StoreModel(sourceHash, modelData);
+			DerivedDataCache::PrintStatistics();
 		}
 
-		std::string modelName = path.filename().string();
+		const int64_t geometryBytes = static_cast<int64_t>(GetGeometryBytes(modelData.meshes));
+		auto releaseGeometry = [&]()
+		{
+			if (report && !modelData.meshes.empty())
+				report->AddStagingBytes(-geometryBytes);
+			modelData.meshes = {};
+		};
 
-		// Extract Vertex and Index Information
-		std::vector<Mesh> meshes;
-		int32_t meshIdIncrementor = 0;
-		for (const fastgltf::Mesh& mesh : asset->meshes)
+		bool recorded = RecordStage("full", true, [&](MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
 		{
-			std::vector<Primitive> primitives;
+			std::vector<std::shared_ptr<Texture>> textures;
+			UploadTextures(modelData.textures, textures, commandList, uploadBytes, report);
 
-			for (const fastgltf::Primitive& primitive : mesh.primitives)
-			{
-				std::vector<uint32_t> indices;
-				ExtractIndices(asset.get(), primitive, indices);
-				std::vector<Vertex> vertices;
-				bool generateTangents = false;
-				ExtractVertices(asset.get(), primitive, vertices, generateTangents);
+			// the buffers of the geometry stage are final already
+			if (meshes.empty())
+				meshes = CreateMeshes(MakePrimitiveViews(modelData.meshes), uploadBytes);
 
-				if (generateTangents)
-					GenerateTangents(vertices, indices);
+			// vertices and indices are packed into the primitive buffers, the cache entry was written before
+			if (GLTFLoader::releaseStagingCopies)
+				releaseGeometry();
 
-				GenerateBiTangents(vertices);
+			return AssembleModel(modelData.name, std::move(meshes), modelData.materials, std::move(textures), modelData.nodes);
+		}, onStage, report, batch);
 
-				auto materialIndex = primitive.materialIndex.value();
-				primitives.emplace_back(Primitive{vertices, indices, static_cast<int32_t>(materialIndex)});
-			}
+		// the previous retention held it until the load returned
+		releaseGeometry();
+		return recorded;
+	}
+
+	bool GLTFLoader::StreamModelFromCache(const std::filesystem::path& path, uint64_t sourceHash, const StageCallback& onStage, ImportReport::Recorder* report, UploadBatch* batch)
+	{
+		PackageReader reader;
+		if (!DerivedDataCache::FindModel(sourceHash, reader))
+			return false;
 
-			meshes.emplace_back(Mesh(meshIdIncrementor++, primitives));
+		ModelPackage::ModelView view;
+		if (!ModelPackage::ReadModel(reader, view))
+		{
+			PRINT("DerivedDataCache: corrupt model entry for ", path.string());
+			return false;
 		}
 
-		// extract materials and textures
-		std::vector<Material> materials;
-		std::vector<Texture> textures;
-		int32_t textureIndexIncrementor = 0;
-		for (const fastgltf::Material& gltfMaterial : asset->materials)
+		// every texture is its own cache entry
+		auto uploadTexture = [](uint32_t textureIndex, const ModelPackage::TextureView& textureView, uint32_t maxSize, std::shared_ptr<Texture>& texture, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
 		{
-			Material material;
+			PackageReader textureReader;
+			return DerivedDataCache::FindTexture(textureView.contentHash, textureView.textureType, textureReader)
+				&& UploadPackageTexture(textureReader, 0, textureView, maxSize, texture, commandList, uploadBytes);
+		};
 
-			material._alphaMode = gltfMaterial.alphaMode;
-			material._pbrFactors.baseColorFactor = Utils::ToXMFloat4(gltfMaterial.pbrData.baseColorFactor);
-			material._pbrFactors.metallicFactor = gltfMaterial.pbrData.metallicFactor;
-			material._pbrFactors.roughnessFactor = gltfMaterial.pbrData.roughnessFactor;
+		if (report)
+			report->_source = "cache";
 
-			// 1. BaseColor (Albedo)
-			material._baseColorTextureIndex = textureIndexIncrementor++;
-			if (gltfMaterial.pbrData.baseColorTexture.has_value())
-			{
-				size_t textureIndex = gltfMaterial.pbrData.baseColorTexture->textureIndex;
+		return StreamModelView(path.filename().string(), view, uploadTexture, onStage, report, batch);
+	}
 
-				const fastgltf::Texture& assetTexture = asset->textures[textureIndex];
-				size_t imageIndex = assetTexture.imageIndex.value();
-				const fastgltf::Image& assetImage = asset->images[imageIndex];
+	bool GLTFLoader::StreamModelFromPackage(const std::filesystem::path& path, const StageCallback& onStage, ImportReport::Recorder* report, UploadBatch* batch)
+	{
+		if (report)
+		{
+			report->_name = path.filename().string();
+			report->_source = "package";
+		}
 
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_ALBEDO;
-				ScratchImage scratchImage = ExtractImageFromBuffer(asset.get(), assetImage);
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
-			}
+		PackageReader reader;
+		uint32_t packageVersion = 0;
+		if (!reader.Open(path, ModelPackage::PACKAGE_VERSION, &packageVersion))
+		{
+			if (packageVersion != 0 && packageVersion != ModelPackage::PACKAGE_VERSION)
+				PRINT("Package ", path.string(), " has format version ", packageVersion, ", this build reads version ", ModelPackage::PACKAGE_VERSION, ": cook it again with artisDX-cook");
 			else
+				PRINT("Failed to open package ", path.string(), " (missing or corrupt)");
+			return false;
+		}
+
+		ModelPackage::ModelView view;
+		if (!ModelPackage::ReadModel(reader, view))
+		{
+			PRINT("Corrupt package ", path.string());
+			return false;
+		}
+
+		// cooked textures are indexed like the material slots
+		auto uploadTexture = [&](uint32_t textureIndex, const ModelPackage::TextureView& textureView, uint32_t maxSize, std::shared_ptr<Texture>& texture, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
+		{
+			if (UploadPackageTexture(reader, textureIndex, textureView, maxSize, texture, commandList, uploadBytes))
+				return true;
+
+			PRINT("Package ", path.string(), " misses texture ", textureIndex);
+			return false;
+		};
+
+		return StreamModelView(view.name, view, uploadTexture, onStage, report, batch);
+	}
+
+	bool GLTFLoader::StreamModelView(const std::string& name, const ModelPackage::ModelView& view, const PackageTextureSource& textureSource, const StageCallback& onStage, ImportReport::Recorder* report, UploadBatch* batch)
+	{
+		// duplicates carry no blob and are found through the TextureCache
+		auto uploadTextures = [&](uint32_t maxTextureSize, std::vector<std::shared_ptr<Texture>>& textures, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
+		{
+			textures.resize(view.textures.size());
+			for (size_t textureIndex = 0; textureIndex < view.textures.size(); ++textureIndex)
 			{
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_ALBEDO;
-				ScratchImage scratchImage = LoadFallbackAlbedoTexture();
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+				const ModelPackage::TextureView& textureView = view.textures[textureIndex];
+
+				if (!textureView.hasImage)
+				{
+					textures[textureIndex] = TextureCache::GetFallbackTexture(textureView.textureType);
+					continue;
+				}
+
+				if ((textures[textureIndex] = TextureCache::Find(textureView.contentHash, textureView.textureType)))
+					continue;
+
+				if (!textureSource(static_cast<uint32_t>(textureIndex), textureView, maxTextureSize, textures[textureIndex], commandList, uploadBytes))
+					return false;
 			}
 
-			// 2. Metallic-Roughness
-			material._metallicRoughnessTextureIndex = textureIndexIncrementor++;
-			if (gltfMaterial.pbrData.metallicRoughnessTexture.has_value())
+			return true;
+		};
+
+		// coarsest lod of every primitive and the mip tail of every texture: a small upload that is visible early
+		std::vector<Mesh> coarseMeshes;
+		if (GLTFLoader::progressiveStreaming && !batch)
+		{
+			bool recorded = RecordStage("coarse", false, [&](MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes) -> std::shared_ptr<Model>
 			{
-				size_t textureIndex = gltfMaterial.pbrData.metallicRoughnessTexture->textureIndex;
+				std::vector<std::shared_ptr<Texture>> textures;
+				if (!uploadTextures(GLTFLoader::coarseTextureSize, textures, commandList, uploadBytes))
+					return nullptr;
+
+				std::vector<std::vector<PrimitiveData>> coarsePrimitives(view.meshes.size());
+				for (size_t meshIndex = 0; meshIndex < view.meshes.size(); ++meshIndex)
+					for (const PrimitiveView& primitiveView : view.meshes[meshIndex])
+						coarsePrimitives[meshIndex].push_back(ExtractCoarsestLod(primitiveView));
+
+				coarseMeshes = CreateMeshes(MakePrimitiveViews(coarsePrimitives), uploadBytes);
+
+				return AssembleModel(name, coarseMeshes, view.materials, std::move(textures), view.nodes);
+			}, onStage, report);
+
+			if (!recorded)
+				return false;
+		}
+
+		return RecordStage("full", true, [&](MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes) -> std::shared_ptr<Model>
+		{
+			std::vector<std::shared_ptr<Texture>> textures;
+			if (!uploadTextures(0, textures, commandList, uploadBytes))
+				return nullptr;
+
+			return AssembleModel(name, CreateMeshes(view.meshes, uploadBytes, coarseMeshes), view.materials, std::move(textures), view.nodes);
+		}, onStage, report, batch);
+	}
+
+	bool GLTFLoader::RecordStage(const std::string& stageName, bool isFinal, const StageRecorder& record, const StageCallback& onStage, ImportReport::Recorder* report, UploadBatch* batch)
+	{
+		ModelStage stage;
+		stage.name = stageName;
+		stage.isFinal = isFinal;
 
-				const fastgltf::Texture& assetTexture = asset->textures[textureIndex];
-				size_t imageIndex = assetTexture.imageIndex.value();
-				const fastgltf::Image& assetImage = asset->images[imageIndex];
+		// the list of a batch is shared, the other loads keep processing while one of them records
+		std::unique_lock<std::mutex> batchLock;
+		if (batch)
+		{
+			batchLock = std::unique_lock<std::mutex>(batch->recordMutex);
+			stage.uploadContext = batch->uploadContext;
+		}
+		else
+		{
+			stage.uploadContext = std::make_shared<CommandContext>();
+			stage.uploadContext->InitializeCommandContext(QUEUETYPE::QUEUE_UPLOAD);
+		}
 
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_METALLICROUGHNESS;
-				ScratchImage scratchImage = ExtractImageFromBuffer(asset.get(), assetImage);
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+		std::exception_ptr exception;
+		{
+			// buffer creation and texture upload recording, the submit is not part of it
+			ImportReport::ScopedStage scope(report, ImportReport::STAGE_UPLOADRECORDING);
+			try
+			{
+				stage.model = record(stage.uploadContext->GetCommandList(), stage.uploadBytes);
 			}
-			else
+			catch (...)
 			{
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_METALLICROUGHNESS;
-				ScratchImage scratchImage = LoadFallbackMetallicRoughnessTexture();
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+				exception = std::current_exception();
+				stage.model = nullptr;
 			}
+			scope._bytes = stage.uploadBytes;
+		}
 
-			// 3. Normal
-			material._normalTextureIndex = textureIndexIncrementor++;
-			if (gltfMaterial.normalTexture.has_value())
-			{
-				size_t textureIndex = gltfMaterial.normalTexture->textureIndex;
+		// upload heaps of the textures this stage recorded live until ModelManager sees them resident
+		if (report && stage.model)
+		{
+			std::vector<const Texture*> recordedTextures;
+			for (const std::shared_ptr<Texture>& texture : stage.model->GetTextures())
+				if (texture->_uploadRecordingId == stage.uploadContext->GetRecordingId())
+					recordedTextures.push_back(texture.get());
+
+			std::sort(recordedTextures.begin(), recordedTextures.end());
+			recordedTextures.erase(std::unique(recordedTextures.begin(), recordedTextures.end()), recordedTextures.end());
+			for (const Texture* texture : recordedTextures)
+				report->AddStagingBytes(static_cast<int64_t>(texture->GetUploadHeapBytes()));
+		}
 
-				const fastgltf::Texture& assetTexture = asset->textures[textureIndex];
-				size_t imageIndex = assetTexture.imageIndex.value();
-				const fastgltf::Image& assetImage = asset->images[imageIndex];
+		if (batchLock)
+			batchLock.unlock();
 
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_NORMAL;
-				ScratchImage scratchImage = ExtractImageFromBuffer(asset.get(), assetImage);
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+		// every uploaded byte was written into an upload heap once
+		if (report)
+			report->AddCopiedBytes(stage.uploadBytes);
+
+		// submitted either way, the list may already hold uploads of textures other loads found in the TextureCache. The
+		// TextureCache holds the context and every texture recorded into it until the fence, a failed stage is dropped
+		// right here. A batch is submitted once every load recorded
+		if (!batch)
+		{
+			uint64_t recordingId = stage.uploadContext->GetRecordingId();
+			try
+			{
+				stage.fenceValue = stage.uploadContext->Finish(false);
 			}
-			else
+			catch (...)
 			{
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_NORMAL;
-				ScratchImage scratchImage = LoadFallbackNormalTexture();
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+				// never uploaded, other loads must not take them for resident
+				TextureCache::EvictPendingUploads(recordingId);
+				throw;
 			}
+			TextureCache::PublishUploadFence(recordingId, stage.fenceValue, stage.uploadContext);
+			AssignUploadFence(stage, recordingId);
+		}
 
-			// 4. Emissive
-			material._emissiveTextureIndex = textureIndexIncrementor++;
-			if (gltfMaterial.emissiveTexture.has_value())
-			{
-				size_t textureIndex = gltfMaterial.emissiveTexture->textureIndex;
+		if (exception)
+			std::rethrow_exception(exception);
 
-				const fastgltf::Texture& assetTexture = asset->textures[textureIndex];
-				size_t imageIndex = assetTexture.imageIndex.value();
-				const fastgltf::Image& assetImage = asset->images[imageIndex];
+		if (!stage.model)
+			return false;
 
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_EMISSIVE;
-				ScratchImage scratchImage = ExtractImageFromBuffer(asset.get(), assetImage);
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
-			}
-			else
+		onStage(std::move(stage));
+		return true;
+	}
+
+	uint64_t GLTFLoader::SubmitUploadBatch(UploadBatch& batch, std::span<ModelStage> stages)
+	{
+		uint64_t recordingId = batch.uploadContext->GetRecordingId();
+		uint64_t fenceValue = batch.uploadContext->Finish(false);
+
+		// failed loads leave no stage behind, their recorded textures are still published (and held) through the cache
+		TextureCache::PublishUploadFence(recordingId, fenceValue, batch.uploadContext);
+		for (ModelStage& stage : stages)
+		{
+			if (!stage.model)
+				continue;
+
+			stage.fenceValue = fenceValue;
+			AssignUploadFence(stage, recordingId);
+		}
+
+		return fenceValue;
+	}
+
+	void GLTFLoader::AssignUploadFence(const ModelStage& stage, uint64_t recordingId)
+	{
+		if (stage.model)
+			for (const std::shared_ptr<Texture>& texture : stage.model->GetTextures())
+				if (texture->_uploadRecordingId == recordingId)
+					texture->_uploadFenceValue = stage.fenceValue;
+	}
+
+	PrimitiveData GLTFLoader::ExtractCoarsestLod(const PrimitiveView& view)
+	{
+		PrimitiveData data;
+		data.materialIndex = view.materialIndex;
+
+		if (view.lods.empty())
+		{
+			data.vertices.assign(view.vertices.begin(), view.vertices.end());
+			data.indices.assign(view.indices.begin(), view.indices.end());
+			data.meshlets.assign(view.meshlets.begin(), view.meshlets.end());
+			return data;
+		}
+
+		const MeshProcessing::LodLevel& lod = view.lods.back();
+
+		// only the vertices the level references, in order of first use which keeps the fetch locality of the optimized buffer
+		std::vector<uint32_t> remap(view.vertices.size(), UINT32_MAX);
+		data.indices.reserve(lod.indexCount);
+		for (uint32_t index : view.indices.subspan(lod.indexOffset, lod.indexCount))
+		{
+			if (remap[index] == UINT32_MAX)
 			{
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_EMISSIVE;
-				ScratchImage scratchImage = LoadFallbackEmissiveTexture();
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+				remap[index] = static_cast<uint32_t>(data.vertices.size());
+				data.vertices.push_back(view.vertices[index]);
 			}
+			data.indices.push_back(remap[index]);
+		}
 
-			// 5. Occlusion
-			material._occlusionTextureIndex = textureIndexIncrementor++;
-			if (gltfMaterial.occlusionTexture.has_value())
-			{
-				size_t textureIndex = gltfMaterial.occlusionTexture->textureIndex;
+		// the level moves to the start of the index buffer, its meshlets move with it
+		data.meshlets.assign(view.meshlets.begin() + lod.meshletOffset, view.meshlets.begin() + lod.meshletOffset + lod.meshletCount);
+		for (MeshProcessing::Meshlet& meshlet : data.meshlets)
+			meshlet.indexOffset -= lod.indexOffset;
 
-				const fastgltf::Texture& assetTexture = asset->textures[textureIndex];
-				size_t imageIndex = assetTexture.imageIndex.value();
-				const fastgltf::Image& assetImage = asset->images[imageIndex];
+		data.lods.push_back({ 0, lod.indexCount, 0, lod.meshletCount, lod.error });
 
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_OCCLUSION;
-				ScratchImage scratchImage = ExtractImageFromBuffer(asset.get(), assetImage);
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
-			}
-			else
+		return data;
+	}
+
+	bool GLTFLoader::UploadPackageTexture(const PackageReader& reader, uint32_t textureIndex, const ModelPackage::TextureView& textureView, uint32_t maxSize, std::shared_ptr<Texture>& texture, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)
+	{
+		// mips are uploaded straight out of the mapping, no decode and no copy into a ScratchImage
+		TexMetadata metadata;
+		std::vector<Image> images;
+		if (!ModelPackage::ReadTexture(reader, textureIndex, metadata, images))
+			return false;
+
+		// with a size limit only the tail of the chain that fits is uploaded, its first mip becomes the top level
+		// (which has to be whole blocks for block compressed formats)
+		auto isValidTopLevel = [&](const Image& image) { return !IsCompressed(metadata.format) || (image.width % 4 == 0 && image.height % 4 == 0); };
+		size_t firstMip = 0;
+		if (maxSize > 0)
+			while (firstMip + 1 < images.size() && std::max(images[firstMip].width, images[firstMip].height) > maxSize && isValidTopLevel(images[firstMip + 1]))
+				++firstMip;
+
+		metadata.width = images[firstMip].width;
+		metadata.height = images[firstMip].height;
+		metadata.mipLevels -= firstMip;
+
+		for (size_t mip = firstMip; mip < images.size(); ++mip)
+			uploadBytes += images[mip].slicePitch;
+
+		std::shared_ptr<Texture> uploaded = std::make_shared<Texture>(commandList, textureView.textureType, metadata, images.data() + firstMip, images.size() - firstMip);
+
+		// a reduced chain is a placeholder of this load, other models must not find it in the cache
+		if (firstMip > 0)
+		{
+			TextureCache::TrackUpload(uploaded);
+			texture = uploaded;
+		}
+		else
+		{
+			texture = TextureCache::Insert(textureView.contentHash, textureView.textureType, uploaded);
+		}
+		return true;
+	}
+
+	bool GLTFLoader::WriteModelPackage(const ModelData& modelData, const std::filesystem::path& path, uint64_t* writtenBytes)
+	{
+		PackageWriter writer;
+		ModelPackage::WriteModel(writer, modelData);
+
+		// only the first job of an (image, type) pair owns pixels, see ProcessTextures
+		for (size_t jobIndex = 0; jobIndex < modelData.textures.size(); ++jobIndex)
+		{
+			const TextureJob& textureJob = modelData.textures[jobIndex];
+			if (textureJob.scratchImage.GetImageCount() > 0)
+				ModelPackage::WriteTexture(writer, static_cast<uint32_t>(jobIndex), textureJob.scratchImage);
+		}
+
+		return writer.WriteToFile(path, ModelPackage::PACKAGE_VERSION, writtenBytes);
+	}
+
+	bool GLTFLoader::ImportModelData(const std::filesystem::path& path, ModelData& modelData, const GeometryCallback& onGeometry, ImportReport::Recorder* report)
+	{
+		fastgltf::Asset asset;
+		if (!ParseAsset(path, asset, report))
+			return false;
+
+		modelData.name = path.filename().string();
+
+		// Extract Vertex and Index Information
+		MeshProcessing::OptimizationStatistics optimizationStatistics;
+		ExtractPrimitives(asset, modelData.meshes, &optimizationStatistics, report);
+		if (report)
+			report->AddStagingBytes(static_cast<int64_t>(GetGeometryBytes(modelData.meshes)));
+		if (MeshProcessing::weldVertices || MeshProcessing::optimizeMeshes)
+			optimizationStatistics.Print(modelData.name);
+
+		// extract materials and textures
+		ExtractMaterials(asset, modelData.materials, modelData.textures);
+
+		ExtractNodes(asset, modelData.nodes);
+
+		if (onGeometry)
+			onGeometry(modelData);
+
+		// decode + mips on the worker pool
+		ProcessTextures(asset, modelData.textures, report);
+
+		return true;
+	}
+
+	std::vector<std::vector<PrimitiveView>> GLTFLoader::MakePrimitiveViews(const std::vector<std::vector<PrimitiveData>>& meshPrimitives)
+	{
+		std::vector<std::vector<PrimitiveView>> meshViews(meshPrimitives.size());
+		for (size_t meshIndex = 0; meshIndex < meshPrimitives.size(); ++meshIndex)
+			for (const PrimitiveData& data : meshPrimitives[meshIndex])
+				meshViews[meshIndex].push_back({ data.vertices, data.indices, data.lods, data.meshlets, data.materialIndex });
+
+		return meshViews;
+	}
+
+	std::vector<Mesh> GLTFLoader::CreateMeshes(const std::vector<std::vector<PrimitiveView>>& meshViews, uint64_t& uploadBytes, const std::vector<Mesh>& residentMeshes)
+	{
+		// GPU buffers are created in mesh/primitive order, independent of how extraction was scheduled
+		std::vector<Mesh> meshes;
+		int32_t meshIdIncrementor = 0;
+		for (size_t meshIndex = 0; meshIndex < meshViews.size(); ++meshIndex)
+		{
+			std::vector<Primitive> primitives;
+			primitives.reserve(meshViews[meshIndex].size());
+
+			for (size_t primitiveIndex = 0; primitiveIndex < meshViews[meshIndex].size(); ++primitiveIndex)
 			{
-				Texture::TEXTURETYPE texType = Texture::TEXTURETYPE::TEXTURE_OCCLUSION;
-				ScratchImage scratchImage = LoadFallbackOcclusionTexture();
-				textures.emplace_back(Texture(commandList, texType, scratchImage));
+				const PrimitiveView& view = meshViews[meshIndex][primitiveIndex];
+
+				// a single level is its own coarsest level, the earlier stage uploaded exactly these buffers
+				if (view.lods.size() <= 1 && meshIndex < residentMeshes.size())
+				{
+					primitives.push_back(residentMeshes[meshIndex]._primitives[primitiveIndex]);
+					continue;
+				}
+
+				Primitive& primitive = primitives.emplace_back(Primitive{ view.vertices, view.indices, view.lods, view.meshlets, view.materialIndex });
+				uploadBytes += primitive.GetBufferBytes();
 			}
+
+			meshes.emplace_back(Mesh(meshIdIncrementor++, std::move(primitives)));
+		}
+
+		return meshes;
+	}
+
+	std::shared_ptr<Model> GLTFLoader::AssembleModel(const std::string& name, std::vector<Mesh> meshes, const std::vector<MaterialData>& materialData, std::vector<std::shared_ptr<Texture>> textures, const std::vector<NodeData>& nodeData)
+	{
+		std::vector<Material> materials;
+		materials.reserve(materialData.size());
+		for (const MaterialData& data : materialData)
+		{
+			Material material;
+			material._alphaMode = data.alphaMode;
+			material._pbrFactors = data.pbrFactors;
+			material._baseColorTextureIndex = data.textureIndices[Texture::TEXTURETYPE::TEXTURE_ALBEDO];
+			material._ormTextureIndex = data.textureIndices[Texture::TEXTURETYPE::TEXTURE_ORM];
+			material._normalTextureIndex = data.textureIndices[Texture::TEXTURETYPE::TEXTURE_NORMAL];
+			material._emissiveTextureIndex = data.textureIndices[Texture::TEXTURETYPE::TEXTURE_EMISSIVE];
 			materials.push_back(material);
 		}
 
 		std::vector<ModelNode> modelNodes;
 		int32_t nodeIdIncrementor = 0;
-		modelNodes.reserve(asset->nodes.size());
+		modelNodes.reserve(nodeData.size());
 
-		for (const fastgltf::Node& node : asset->nodes)
+		for (const NodeData& data : nodeData)
 		{
 			ModelNode modelNode;
 			modelNode._id = nodeIdIncrementor++;
-			modelNode._name = node.name.data() ? node.name : "UnnamedNode";
-			modelNode._meshIndex = node.meshIndex.has_value() ? static_cast<int>(*node.meshIndex) : -1;
-
-			modelNode._localMatrix = Utils::ToXMFloat4x4(fastgltf::getTransformMatrix(node));
+			modelNode._name = data.name;
+			modelNode._meshIndex = data.meshIndex;
+			modelNode._parentIndex = data.parentIndex;
+			modelNode._children = data.children;
+			modelNode._localMatrix = data.localMatrix;
 
 			XMMATRIX M = XMLoadFloat4x4(&modelNode._localMatrix);
 			XMVECTOR translation, rotation, scale;
@@ -197,233 +546,1164 @@ namespace GLTFLoader
 			XMStoreFloat3(&modelNode._scale, scale);
 			XMStoreFloat4(&modelNode._rotationQuat, rotation);
 
-			modelNodes.push_back(modelNode);
+			modelNodes.push_back(std::move(modelNode));
 		}
 
-		for (size_t i = 0; i < asset->nodes.size(); ++i)
+		return std::make_shared<Model>(modelIdIncrementor++, name, std::move(meshes), std::move(textures), std::move(materials), std::move(modelNodes));
+	}
+
+	bool GLTFLoader::ParseAsset(const std::filesystem::path& path, fastgltf::Asset& asset, ImportReport::Recorder* report)
+	{
+		constexpr auto gltfOptions =
+			fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble
+			| fastgltf::Options::LoadExternalBuffers
+			| fastgltf::Options::LoadExternalImages | fastgltf::Options::DecomposeNodeMatrices
+			| fastgltf::Options::None;
+
+		ImportReport::ScopedStage fileMapScope(report, ImportReport::STAGE_FILEMAP);
+		auto data = fastgltf::MappedGltfFile::FromPath(path);
+		if (!bool(data)) {
+			std::cerr << "Failed to open glTF file at " << path << ". Error: " << fastgltf::getErrorMessage(data.error()) << '\n';
+			return false;
+		}
+		fileMapScope._bytes = data.get().totalSize();
+		fileMapScope.Stop();
+
+		ImportReport::ScopedStage parseScope(report, ImportReport::STAGE_JSONPARSE);
+		auto loadedAsset = GLTFLoader::parser.loadGltf(data.get(), path.parent_path(), gltfOptions);
+		if (auto error = loadedAsset.error(); error != fastgltf::Error::None)
 		{
-			const fastgltf::Node& node = asset->nodes[i];
-			for (auto childIndex : node.children) {
-				modelNodes[i]._children.push_back(static_cast<int>(childIndex));
-				modelNodes[childIndex]._parentIndex = static_cast<int>(i);
-			}
+			// Some error occurred while reading the buffer, parsing the JSON, or validating the data.
+			std::cout << "Error occurred while parsing " << path << ": " << fastgltf::getErrorMessage(error) << '\n';
+			if (error == fastgltf::Error::MissingExtensions || error == fastgltf::Error::UnsupportedExtensions)
+				std::cout << "  supported compression: EXT_meshopt_compression, KHR_draco_mesh_compression, KHR_mesh_quantization" << '\n';
+			return false;
 		}
 
-		model = std::make_shared<Model>(modelIdIncrementor++, modelName, meshes, std::move(textures), materials, modelNodes);
+		asset = std::move(loadedAsset.get());
 
-		return true;
+		// external buffers are loaded while parsing, their bytes count towards it
+		for (const fastgltf::Buffer& buffer : asset.buffers)
+			parseScope._bytes += buffer.byteLength;
+		parseScope.Stop();
+
+		return DecodeCompressedBufferViews(asset, report) && DecodeDracoPrimitives(asset, report);
+	}
+
+	std::span<const uint8_t> GLTFLoader::GetBufferBytes(const fastgltf::Buffer& buffer, std::string* error)
+	{
+		if (auto arrayPtr = std::get_if<fastgltf::sources::Array>(&buffer.data))
+			return { reinterpret_cast<const uint8_t*>(arrayPtr->bytes.data()), arrayPtr->bytes.size() };
+		if (auto vectorPtr = std::get_if<fastgltf::sources::Vector>(&buffer.data))
+			return { reinterpret_cast<const uint8_t*>(vectorPtr->bytes.data()), vectorPtr->bytes.size() };
+		if (auto byteViewPtr = std::get_if<fastgltf::sources::ByteView>(&buffer.data))
+			return { reinterpret_cast<const uint8_t*>(byteViewPtr->bytes.data()), byteViewPtr->bytes.size() };
+
+		if (error)
+		{
+			if (std::holds_alternative<fastgltf::sources::Fallback>(buffer.data))
+				*error = "the buffer is an EXT_meshopt_compression fallback without data";
+			else if (auto uriPtr = std::get_if<fastgltf::sources::URI>(&buffer.data))
+				*error = "the buffer " + std::string(uriPtr->uri.string()) + " was not loaded, only local files are";
+			else
+				*error = "the buffer has no data";
+		}
+		return {};
 	}
 
-	ScratchImage GLTFLoader::ExtractImageFromBuffer(const fastgltf::Asset& asset, const fastgltf::Image& assetImage)
+	bool GLTFLoader::DecodeCompressedBufferViews(fastgltf::Asset& asset, ImportReport::Recorder* report)
 	{
-		const uint8_t* pixelData = nullptr;
-		size_t pixelSize = 0;
-		ScratchImage scratchImage;
+		std::vector<size_t> compressedViews;
+		for (size_t viewIndex = 0; viewIndex < asset.bufferViews.size(); ++viewIndex)
+			if (asset.bufferViews[viewIndex].meshoptCompression)
+				compressedViews.push_back(viewIndex);
 
-		if (auto bufferViewPtr = std::get_if<fastgltf::sources::BufferView>(&assetImage.data))
+		if (compressedViews.empty())
+			return true;
+
+		ImportReport::ScopedStage scope(report, ImportReport::STAGE_BUFFERDECODE);
+
+		// decoded into the storage type of sources::Array so the result becomes a buffer without another copy
+		using ByteStorage = decltype(fastgltf::sources::Array::bytes);
+		std::vector<ByteStorage> decodedViews(compressedViews.size());
+		// empty once the view is decoded
+		std::vector<std::string> errors(compressedViews.size(), "not decoded");
+
+		JobSystem::ParallelFor(compressedViews.size(), [&](size_t jobIndex)
 		{
-			const fastgltf::sources::BufferView& view = *bufferViewPtr;
-			const auto& bufferViewMeta = asset.bufferViews[view.bufferViewIndex];
-			const auto& buffer = asset.buffers[bufferViewMeta.bufferIndex];
+			const fastgltf::CompressedBufferView& compressed = *asset.bufferViews[compressedViews[jobIndex]].meshoptCompression;
+
+			std::string bufferError;
+			std::span<const uint8_t> bufferBytes = GetBufferBytes(asset.buffers[compressed.bufferIndex], &bufferError);
+			if (compressed.byteOffset + compressed.byteLength > bufferBytes.size())
+			{
+				errors[jobIndex] = bufferError.empty() ? "the compressed range exceeds its buffer" : bufferError;
+				return;
+			}
+
+			const unsigned char* source = bufferBytes.data() + compressed.byteOffset;
+
+			ByteStorage bytes(compressed.count * compressed.byteStride);
+			void* destination = bytes.data();
+
+			int result = -1;
+			switch (compressed.mode)
+			{
+			case fastgltf::MeshoptCompressionMode::Attributes:
+				result = meshopt_decodeVertexBuffer(destination, compressed.count, compressed.byteStride, source, compressed.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Triangles:
+				result = meshopt_decodeIndexBuffer(destination, compressed.count, compressed.byteStride, source, compressed.byteLength);
+				break;
+			case fastgltf::MeshoptCompressionMode::Indices:
+				result = meshopt_decodeIndexSequence(destination, compressed.count, compressed.byteStride, source, compressed.byteLength);
+				break;
+			}
+
+			if (result != 0)
+			{
+				errors[jobIndex] = "meshoptimizer rejected the stream (" + std::to_string(result) + ")";
+				return;
+			}
+
+			// filters run in place on the decoded stream
+			switch (compressed.filter)
+			{
+			case fastgltf::MeshoptCompressionFilter::Octahedral:
+				meshopt_decodeFilterOct(destination, compressed.count, compressed.byteStride);
+				break;
+			case fastgltf::MeshoptCompressionFilter::Quaternion:
+				meshopt_decodeFilterQuat(destination, compressed.count, compressed.byteStride);
+				break;
+			case fastgltf::MeshoptCompressionFilter::Exponential:
+				meshopt_decodeFilterExp(destination, compressed.count, compressed.byteStride);
+				break;
+			default:
+				break;
+			}
 
-			if (auto arrayPtr = std::get_if<fastgltf::sources::Array>(&buffer.data))
+			decodedViews[jobIndex] = std::move(bytes);
+			errors[jobIndex].clear();
+		});
+
+		// every decoded view gets a buffer of its own, the compressed buffers stay untouched (images may live in them)
+		uint64_t compressedBytes = 0;
+		uint64_t decodedBytes = 0;
+		for (size_t jobIndex = 0; jobIndex < compressedViews.size(); ++jobIndex)
+		{
+			fastgltf::BufferView& bufferView = asset.bufferViews[compressedViews[jobIndex]];
+			if (!errors[jobIndex].empty())
 			{
-				pixelData = reinterpret_cast<const uint8_t*>(arrayPtr->bytes.data()) + bufferViewMeta.byteOffset;
-				pixelSize = bufferViewMeta.byteLength;
+				PRINT("EXT_meshopt_compression: failed to decode buffer view ", compressedViews[jobIndex], ": ", errors[jobIndex]);
+				return false;
 			}
+
+			compressedBytes += bufferView.meshoptCompression->byteLength;
+			decodedBytes += decodedViews[jobIndex].size();
+
+			fastgltf::Buffer buffer;
+			buffer.byteLength = decodedViews[jobIndex].size();
+			fastgltf::sources::Array array;
+			array.bytes = std::move(decodedViews[jobIndex]);
+			buffer.data = std::move(array);
+
+			bufferView.bufferIndex = asset.buffers.size();
+			bufferView.byteOffset = 0;
+			bufferView.byteLength = buffer.byteLength;
+			bufferView.meshoptCompression.reset();
+			asset.buffers.push_back(std::move(buffer));
 		}
 
-		if (!pixelData || pixelSize == 0)
-			ThrowException("no pixeldata while loading image");
+		scope._bytes = decodedBytes;
+		PRINT("EXT_meshopt_compression: ", compressedViews.size(), " buffer views | ", compressedBytes / 1024, "KB -> ", decodedBytes / 1024, "KB");
+		return true;
+	}
 
-		ThrowIfFailed(LoadFromWICMemory(pixelData, pixelSize, WIC_FLAGS_NONE, nullptr, scratchImage));
+	// one accessor of a Draco primitive and where its decoded elements start in the primitive's buffer
+	struct DracoStream
+	{
+		size_t accessorIndex = 0;
+		uint32_t dracoId = 0; // unused for the indices
+		size_t byteOffset = 0;
+		size_t byteLength = 0;
+	};
 
-		return scratchImage;
+	struct DracoResult
+	{
+		decltype(fastgltf::sources::Array::bytes) bytes;
+		std::vector<DracoStream> streams; // the attributes, the indices last
+		std::string error;
+	};
+
+	// draco converts (and for normalized accessors rescales) into the component type the accessor declares
+	template <typename ComponentType>
+	bool WriteDracoValues(const draco::Mesh& mesh, const draco::PointAttribute& attribute, int8_t componentCount, uint8_t* destination)
+	{
+		ComponentType values[4];
+		const size_t elementSize = componentCount * sizeof(ComponentType);
+		for (uint32_t point = 0; point < mesh.num_points(); ++point)
+		{
+			if (!attribute.ConvertValue<ComponentType>(attribute.mapped_index(draco::PointIndex(point)), componentCount, values))
+				return false;
+			memcpy(destination + point * elementSize, values, elementSize);
+		}
+		return true;
 	}
 
-	void GLTFLoader::ExtractIndices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<uint32_t>& indices)
+	bool WriteDracoAttribute(const draco::Mesh& mesh, const draco::PointAttribute& attribute, const fastgltf::Accessor& accessor, uint8_t* destination)
 	{
-		const fastgltf::Accessor& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+		const int8_t componentCount = static_cast<int8_t>(fastgltf::getNumComponents(accessor.type));
+		if (componentCount > 4)
+			return false;
 
-		indices.reserve(indexAccessor.count);
+		switch (accessor.componentType)
+		{
+		case fastgltf::ComponentType::Byte:
+			return WriteDracoValues<int8_t>(mesh, attribute, componentCount, destination);
+		case fastgltf::ComponentType::UnsignedByte:
+			return WriteDracoValues<uint8_t>(mesh, attribute, componentCount, destination);
+		case fastgltf::ComponentType::Short:
+			return WriteDracoValues<int16_t>(mesh, attribute, componentCount, destination);
+		case fastgltf::ComponentType::UnsignedShort:
+			return WriteDracoValues<uint16_t>(mesh, attribute, componentCount, destination);
+		case fastgltf::ComponentType::UnsignedInt:
+			return WriteDracoValues<uint32_t>(mesh, attribute, componentCount, destination);
+		case fastgltf::ComponentType::Float:
+			return WriteDracoValues<float>(mesh, attribute, componentCount, destination);
+		default:
+			return false;
+		}
+	}
 
-		fastgltf::iterateAccessor<std::uint32_t>(asset, indexAccessor, [&](std::uint32_t idx) {
-			indices.push_back(idx);
-			});
+	template <typename IndexType>
+	void WriteDracoIndices(const draco::Mesh& mesh, uint8_t* destination)
+	{
+		for (uint32_t face = 0; face < mesh.num_faces(); ++face)
+		{
+			const draco::Mesh::Face& corners = mesh.face(draco::FaceIndex(face));
+			for (uint32_t corner = 0; corner < 3; ++corner)
+			{
+				IndexType index = static_cast<IndexType>(corners[corner].value());
+				memcpy(destination + (face * 3 + corner) * sizeof(IndexType), &index, sizeof(IndexType));
+			}
+		}
 	}
 
-	void GLTFLoader::ExtractVertices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<Vertex>& vertices, bool& generateTangents)
+	// decodes the compressed mesh of the primitive into the layout its accessors declare, result.error says why if not
+	void DecodeDracoPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, DracoResult& result)
 	{
-		const fastgltf::Accessor& positionAccessor = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
-		vertices.resize(vertices.size() + positionAccessor.count);
+		const fastgltf::DracoCompressedPrimitive& compressed = *primitive.dracoCompression;
+		if (primitive.type != fastgltf::PrimitiveType::Triangles || !primitive.indicesAccessor.has_value())
+		{
+			result.error = "only indexed triangle lists are decoded";
+			return;
+		}
 
-		fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset, positionAccessor, [&](fastgltf::math::fvec3 pos, std::size_t idx) {
-			vertices[idx].position = XMFLOAT3(pos.x(), pos.y(), pos.z());
-			});
+		const fastgltf::BufferView& bufferView = asset.bufferViews[compressed.bufferView];
+		std::string bufferError;
+		std::span<const uint8_t> bufferBytes = GLTFLoader::GetBufferBytes(asset.buffers[bufferView.bufferIndex], &bufferError);
+		if (bufferView.byteOffset + bufferView.byteLength > bufferBytes.size())
+		{
+			result.error = bufferError.empty() ? "the compressed range exceeds its buffer" : bufferError;
+			return;
+		}
 
-		if (primitive.findAttribute("NORMAL") != primitive.attributes.end())
+		draco::DecoderBuffer decoderBuffer;
+		decoderBuffer.Init(reinterpret_cast<const char*>(bufferBytes.data() + bufferView.byteOffset), bufferView.byteLength);
+		draco::Decoder decoder;
+		auto decodedMesh = decoder.DecodeMeshFromBuffer(&decoderBuffer);
+		if (!decodedMesh.ok())
 		{
-			const fastgltf::Accessor& normalAccessor = asset.accessors[primitive.findAttribute("NORMAL")->accessorIndex];
-			fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec3>(asset, normalAccessor, [&](fastgltf::math::fvec3 normal, std::size_t idx) {
-				vertices[idx].normal = XMFLOAT3(normal.x(), normal.y(), normal.z());
-				});
+			result.error = decodedMesh.status().error_msg();
+			return;
 		}
+		const std::unique_ptr<draco::Mesh> mesh = std::move(decodedMesh).value();
+
+		// every stream starts 4 byte aligned
+		size_t byteLength = 0;
+		auto addStream = [&](size_t accessorIndex, uint32_t dracoId)
+		{
+			const fastgltf::Accessor& accessor = asset.accessors[accessorIndex];
+			const size_t streamLength = accessor.count * fastgltf::getElementByteSize(accessor.type, accessor.componentType);
+			result.streams.push_back({ accessorIndex, dracoId, byteLength, streamLength });
+			byteLength += (streamLength + 3) & ~size_t(3);
+		};
 
-		if (primitive.findAttribute("TEXCOORD_0") != primitive.attributes.end())
+		for (const fastgltf::Attribute& dracoAttribute : compressed.attributes)
 		{
-			const fastgltf::Accessor& uvAccessor = asset.accessors[primitive.findAttribute("TEXCOORD_0")->accessorIndex];
+			auto it = primitive.findAttribute(dracoAttribute.name);
+			if (it == primitive.attributes.end())
+				continue;
+
+			if (asset.accessors[it->accessorIndex].count != mesh->num_points())
+			{
+				result.error = "the decoded vertex count does not match the " + std::string(std::string_view(dracoAttribute.name)) + " accessor";
+				return;
+			}
+			addStream(it->accessorIndex, static_cast<uint32_t>(dracoAttribute.accessorIndex));
+		}
 
-			fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec2>(asset, uvAccessor, [&](fastgltf::math::fvec2 uv, std::size_t idx) {
-				vertices[idx].uv = XMFLOAT2(uv.x(), uv.y());
-				});
+		const fastgltf::Accessor& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+		if (indexAccessor.count != static_cast<size_t>(mesh->num_faces()) * 3)
+		{
+			result.error = "the decoded index count does not match the indices accessor";
+			return;
 		}
+		addStream(primitive.indicesAccessor.value(), 0);
+
+		result.bytes = decltype(result.bytes)(byteLength);
+		uint8_t* destination = reinterpret_cast<uint8_t*>(result.bytes.data());
 
-		if (primitive.findAttribute("TANGENT") != primitive.attributes.end())
+		for (size_t streamIndex = 0; streamIndex + 1 < result.streams.size(); ++streamIndex)
 		{
-			const fastgltf::Accessor& tangentAccessor = asset.accessors[primitive.findAttribute("TANGENT")->accessorIndex];
+			const DracoStream& stream = result.streams[streamIndex];
+			const draco::PointAttribute* attribute = mesh->GetAttributeByUniqueId(stream.dracoId);
+			if (!attribute || !WriteDracoAttribute(*mesh, *attribute, asset.accessors[stream.accessorIndex], destination + stream.byteOffset))
+			{
+				result.error = "attribute " + std::to_string(stream.dracoId) + " is missing or cannot be converted to its accessor type";
+				return;
+			}
+		}
 
-			fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(asset, tangentAccessor, [&](fastgltf::math::fvec4 tangent, std::size_t idx) {
-				vertices[idx].tangent = XMFLOAT4(tangent.x(), tangent.y(), tangent.z(), tangent.w());
-				});
+		uint8_t* indexDestination = destination + result.streams.back().byteOffset;
+		switch (indexAccessor.componentType)
+		{
+		case fastgltf::ComponentType::UnsignedByte:
+			WriteDracoIndices<uint8_t>(*mesh, indexDestination);
+			break;
+		case fastgltf::ComponentType::UnsignedShort:
+			WriteDracoIndices<uint16_t>(*mesh, indexDestination);
+			break;
+		case fastgltf::ComponentType::UnsignedInt:
+			WriteDracoIndices<uint32_t>(*mesh, indexDestination);
+			break;
+		default:
+			result.error = "the indices accessor has no index component type";
+			return;
+		}
+	}
+
+	bool GLTFLoader::DecodeDracoPrimitives(fastgltf::Asset& asset, ImportReport::Recorder* report)
+	{
+		std::vector<fastgltf::Primitive*> compressedPrimitives;
+		for (fastgltf::Mesh& mesh : asset.meshes)
+			for (fastgltf::Primitive& primitive : mesh.primitives)
+				if (primitive.dracoCompression)
+					compressedPrimitives.push_back(&primitive);
+
+		if (compressedPrimitives.empty())
+			return true;
+
+		ImportReport::ScopedStage scope(report, ImportReport::STAGE_BUFFERDECODE);
+
+		std::vector<DracoResult> results(compressedPrimitives.size());
+		JobSystem::ParallelFor(compressedPrimitives.size(), [&](size_t jobIndex)
+		{
+			DecodeDracoPrimitive(asset, *compressedPrimitives[jobIndex], results[jobIndex]);
+		});
+
+		// every primitive gets a buffer of its own with one view per accessor, the fallback data (if any) stays untouched
+		uint64_t compressedBytes = 0;
+		uint64_t decodedBytes = 0;
+		for (size_t jobIndex = 0; jobIndex < compressedPrimitives.size(); ++jobIndex)
+		{
+			fastgltf::Primitive& primitive = *compressedPrimitives[jobIndex];
+			DracoResult& result = results[jobIndex];
+			if (!result.error.empty())
+			{
+				PRINT("KHR_draco_mesh_compression: failed to decode a primitive: ", result.error);
+				return false;
+			}
+
+			compressedBytes += asset.bufferViews[primitive.dracoCompression->bufferView].byteLength;
+			decodedBytes += result.bytes.size();
+
+			const size_t bufferIndex = asset.buffers.size();
+			for (const DracoStream& stream : result.streams)
+			{
+				fastgltf::BufferView bufferView;
+				bufferView.bufferIndex = bufferIndex;
+				bufferView.byteOffset = stream.byteOffset;
+				bufferView.byteLength = stream.byteLength;
+
+				fastgltf::Accessor& accessor = asset.accessors[stream.accessorIndex];
+				accessor.bufferViewIndex = asset.bufferViews.size();
+				accessor.byteOffset = 0;
+				asset.bufferViews.push_back(std::move(bufferView));
+			}
+
+			fastgltf::Buffer buffer;
+			buffer.byteLength = result.bytes.size();
+			fastgltf::sources::Array array;
+			array.bytes = std::move(result.bytes);
+			buffer.data = std::move(array);
+			asset.buffers.push_back(std::move(buffer));
+
+			primitive.dracoCompression.reset();
+		}
+
+		scope._bytes = decodedBytes;
+		PRINT("KHR_draco_mesh_compression: ", compressedPrimitives.size(), " primitives | ", compressedBytes / 1024, "KB -> ", decodedBytes / 1024, "KB");
+		return true;
+	}
+
+	void GLTFLoader::ExtractPrimitives(const fastgltf::Asset& asset, std::vector<std::vector<PrimitiveData>>& meshPrimitives, MeshProcessing::OptimizationStatistics* statistics, ImportReport::Recorder* report)
+	{
+		// flatten mesh/primitive pairs so every primitive is one job with a fixed output slot
+		std::vector<std::pair<size_t, size_t>> jobs;
+		meshPrimitives.resize(asset.meshes.size());
+		for (size_t meshIndex = 0; meshIndex < asset.meshes.size(); ++meshIndex)
+		{
+			meshPrimitives[meshIndex].resize(asset.meshes[meshIndex].primitives.size());
+			for (size_t primitiveIndex = 0; primitiveIndex < asset.meshes[meshIndex].primitives.size(); ++primitiveIndex)
+				jobs.emplace_back(meshIndex, primitiveIndex);
+		}
+
+		std::vector<MeshProcessing::OptimizationStatistics> jobStatistics(statistics ? jobs.size() : 0);
+
+		auto processJob = [&](size_t jobIndex)
+		{
+			auto [meshIndex, primitiveIndex] = jobs[jobIndex];
+			meshPrimitives[meshIndex][primitiveIndex] = ProcessPrimitive(asset, asset.meshes[meshIndex].primitives[primitiveIndex], statistics ? &jobStatistics[jobIndex] : nullptr, report);
+		};
+
+		if (GLTFLoader::parallelExtraction)
+		{
+			JobSystem::ParallelFor(jobs.size(), processJob);
 		}
 		else
 		{
-			generateTangents = true;
+			for (size_t jobIndex = 0; jobIndex < jobs.size(); ++jobIndex)
+				processJob(jobIndex);
 		}
+
+		for (const MeshProcessing::OptimizationStatistics& primitiveStatistics : jobStatistics)
+			statistics->Add(primitiveStatistics);
 	}
 
-	ScratchImage GLTFLoader::Create1x1Texture(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+	PrimitiveData GLTFLoader::ProcessPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshProcessing::OptimizationStatistics* statistics, ImportReport::Recorder* report)
 	{
-		ScratchImage image;
-		image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 1);
-		uint8_t* pixels = image.GetImage(0, 0, 0)->pixels;
-		pixels[0] = r;
-		pixels[1] = g;
-		pixels[2] = b;
-		pixels[3] = a;
-		return image;
+		// every scratch buffer of the mesh passes below lives in the arena of this thread until the primitive is done
+		ImportArena::Scope arenaScope(report);
+		PrimitiveData data;
+
+		auto geometryBytes = [&data]() { return data.vertices.size() * sizeof(Vertex) + data.indices.size() * sizeof(uint32_t); };
+
+		ImportReport::ScopedStage accessorScope(report, ImportReport::STAGE_ACCESSORS);
+		ExtractIndices(asset, primitive, data.indices);
+		bool generateTangents = false;
+		ExtractVertices(asset, primitive, data.vertices, generateTangents);
+		accessorScope._bytes = geometryBytes();
+		accessorScope.Stop();
+		if (report)
+			report->AddCopiedBytes(accessorScope._bytes);
+
+		if (!primitive.indicesAccessor.has_value() && statistics)
+			++statistics->weld.unindexedPrimitives;
+
+		// exporters often write one vertex per corner, everything after this works on the shared ones
+		if (MeshProcessing::weldVertices)
+		{
+			ImportReport::ScopedStage weldScope(report, ImportReport::STAGE_WELD);
+			MeshProcessing::WeldVertices(data.vertices, data.indices, statistics ? &statistics->weld : nullptr);
+			weldScope._bytes = geometryBytes();
+		}
+
+		if (generateTangents)
+		{
+			ImportReport::ScopedStage tangentScope(report, ImportReport::STAGE_TANGENTS);
+			MeshProcessing::GenerateTangents(data.vertices, data.indices);
+			tangentScope._bytes = geometryBytes();
+		}
+
+		ImportReport::ScopedStage processingScope(report, ImportReport::STAGE_MESHPROCESSING);
+
+		if (MeshProcessing::optimizeMeshes)
+			MeshProcessing::OptimizeMesh(data.vertices, data.indices, statistics);
+
+		// LOD 0 is the optimized source, coarser levels share its vertices
+		data.lods.push_back({ 0, static_cast<uint32_t>(data.indices.size()) });
+		if (MeshProcessing::generateLods)
+			MeshProcessing::GenerateLods(data.vertices, data.indices, data.lods);
+
+		if (MeshProcessing::buildMeshlets)
+			MeshProcessing::BuildMeshlets(data.vertices, data.indices, data.lods, data.meshlets);
+
+		processingScope._bytes = geometryBytes() + data.meshlets.size() * sizeof(MeshProcessing::Meshlet);
+		processingScope.Stop();
+
+		data.materialIndex = static_cast<int32_t>(primitive.materialIndex.value());
+
+		return data;
 	}
 
-	ScratchImage GLTFLoader::LoadFallbackAlbedoTexture()
+	void GLTFLoader::BenchmarkGeometryExtraction(const std::filesystem::path& path, uint32_t repeatCount)
 	{
-		// Default albedo: mid-gray (e.g., base color = 0.5)
-		return Create1x1Texture(255, 0, 200, 120);
+		fastgltf::Asset asset;
+		if (!ParseAsset(path, asset))
+			return;
+
+		// synthetic many-primitive workload: every primitive of the asset is extracted repeatCount times
+		std::vector<const fastgltf::Primitive*> jobs;
+		for (uint32_t i = 0; i < repeatCount; ++i)
+			for (const fastgltf::Mesh& mesh : asset.meshes)
+				for (const fastgltf::Primitive& primitive : mesh.primitives)
+					jobs.push_back(&primitive);
+
+		std::vector<PrimitiveData> serialResults(jobs.size());
+		std::vector<PrimitiveData> parallelResults(jobs.size());
+
+		Utils::Timer::StartTimer();
+		for (size_t i = 0; i < jobs.size(); ++i)
+			serialResults[i] = ProcessPrimitive(asset, *jobs[i]);
+		double serialMs = Utils::Timer::GetElapsedMilliseconds();
+
+		Utils::Timer::StartTimer();
+		JobSystem::ParallelFor(jobs.size(), [&](size_t i) { parallelResults[i] = ProcessPrimitive(asset, *jobs[i]); });
+		double parallelMs = Utils::Timer::GetElapsedMilliseconds();
+
+		bool identical = true;
+		for (size_t i = 0; i < jobs.size() && identical; ++i)
+		{
+			const PrimitiveData& a = serialResults[i];
+			const PrimitiveData& b = parallelResults[i];
+			identical = a.materialIndex == b.materialIndex
+				&& a.indices == b.indices
+				&& a.vertices.size() == b.vertices.size()
+				&& memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) == 0;
+		}
+
+		PRINT("Geometry extraction benchmark: ", path.filename().string(), " | primitives: ", jobs.size(), " | workers: ", JobSystem::GetWorkerCount());
+		PRINT("  serial:   ", serialMs, "ms");
+		PRINT("  parallel: ", parallelMs, "ms (", serialMs / std::max(parallelMs, 0.001), "x)");
+		PRINT("  output identical: ", identical ? "yes" : "NO");
 	}
 
-	ScratchImage GLTFLoader::LoadFallbackMetallicRoughnessTexture()
+	void GLTFLoader::ExtractMaterials(const fastgltf::Asset& asset, std::vector<MaterialData>& materials, std::vector<TextureJob>& textureJobs)
 	{
-		// Default: fully rough (255), non-metal (0)
-		// In glTF, R = Occlusion, G = Roughness, B = Metallic
-		return Create1x1Texture(0, 255, 0);
+		auto textureIndexOf = [](const auto& textureInfo) -> std::optional<size_t>
+		{
+			if (!textureInfo.has_value())
+				return std::nullopt;
+			return textureInfo->textureIndex;
+		};
+
+		// KTX2 first, it transcodes straight to BC with its own mips. The plain image stays as the fallback
+		auto imagesOf = [&](std::optional<size_t> textureIndex)
+		{
+			std::pair<std::optional<size_t>, std::optional<size_t>> images;
+			if (textureIndex.has_value())
+			{
+				const fastgltf::Texture& texture = asset.textures[textureIndex.value()];
+				if (texture.imageIndex.has_value())
+					images.first = texture.imageIndex.value();
+				if (texture.basisuImageIndex.has_value() && TextureProcessing::transcodeBasisu)
+				{
+					images.second = images.first;
+					images.first = texture.basisuImageIndex.value();
+				}
+			}
+			return images;
+		};
+
+		// packing decodes to RGBA8 anyway, so it prefers the plain image over KTX2
+		auto plainImageOf = [](const std::pair<std::optional<size_t>, std::optional<size_t>>& images)
+		{
+			return images.second.has_value() ? images.second : images.first;
+		};
+
+		struct TextureSlot
+		{
+			Texture::TEXTURETYPE texType;
+			std::pair<std::optional<size_t>, std::optional<size_t>> images; // image, fallback image
+			bool packORM = false;
+			std::optional<size_t> occlusionImageIndex;
+		};
+
+		// one job per (images, type, alpha cutoff) and one per fallback type, materials only reference jobs
+		std::map<std::tuple<size_t, std::optional<size_t>, bool, Texture::TEXTURETYPE, float>, int32_t> imageJobs;
+		int32_t fallbackJobs[Texture::TEXTURETYPE_COUNT] = { NOTOK, NOTOK, NOTOK, NOTOK };
+
+		materials.reserve(asset.materials.size());
+		for (const fastgltf::Material& gltfMaterial : asset.materials)
+		{
+			MaterialData material;
+
+			material.alphaMode = gltfMaterial.alphaMode;
+			material.pbrFactors.baseColorFactor = Utils::ToXMFloat4(gltfMaterial.pbrData.baseColorFactor);
+			material.pbrFactors.metallicFactor = gltfMaterial.pbrData.metallicFactor;
+			material.pbrFactors.roughnessFactor = gltfMaterial.pbrData.roughnessFactor;
+
+			// an image that already holds occlusion in R next to metallic/roughness is used as is, separate images
+			// (or only one of them, its missing channels have to read 1) are packed into one ORM texture
+			auto metallicRoughnessImages = imagesOf(textureIndexOf(gltfMaterial.pbrData.metallicRoughnessTexture));
+			auto occlusionImages = imagesOf(textureIndexOf(gltfMaterial.occlusionTexture));
+			std::optional<size_t> metallicRoughnessImage = plainImageOf(metallicRoughnessImages);
+			std::optional<size_t> occlusionImage = plainImageOf(occlusionImages);
+
+			TextureSlot ormSlot = { Texture::TEXTURETYPE::TEXTURE_ORM, metallicRoughnessImages };
+			if (metallicRoughnessImage != occlusionImage)
+			{
+				ormSlot.images = { metallicRoughnessImage.has_value() ? metallicRoughnessImage : occlusionImage, std::nullopt };
+				ormSlot.packORM = true;
+				ormSlot.occlusionImageIndex = occlusionImage;
+			}
+
+			const TextureSlot slots[] =
+			{
+				{ Texture::TEXTURETYPE::TEXTURE_ALBEDO, imagesOf(textureIndexOf(gltfMaterial.pbrData.baseColorTexture)) },
+				ormSlot,
+				{ Texture::TEXTURETYPE::TEXTURE_NORMAL, imagesOf(textureIndexOf(gltfMaterial.normalTexture)) },
+				{ Texture::TEXTURETYPE::TEXTURE_EMISSIVE, imagesOf(textureIndexOf(gltfMaterial.emissiveTexture)) },
+			};
+
+			for (const TextureSlot& slot : slots)
+			{
+				const auto& [imageIndex, fallbackImageIndex] = slot.images;
+
+				// masked albedo keeps its coverage at the material's cutoff through the mips, so every cutoff gets its own
+				// chain. Opaque/blended materials ignore alpha and share the plain one
+				const float alphaCutoff = slot.texType == Texture::TEXTURETYPE::TEXTURE_ALBEDO && imageIndex.has_value() && gltfMaterial.alphaMode == fastgltf::AlphaMode::Mask
+					? gltfMaterial.alphaCutoff : 0.0f;
+
+				int32_t& jobIndex = imageIndex.has_value()
+					? imageJobs.try_emplace({ imageIndex.value(), slot.occlusionImageIndex, slot.packORM, slot.texType, alphaCutoff }, NOTOK).first->second
+					: fallbackJobs[slot.texType];
+				if (jobIndex == NOTOK)
+				{
+					jobIndex = static_cast<int32_t>(textureJobs.size());
+
+					TextureJob& textureJob = textureJobs.emplace_back();
+					textureJob.textureType = slot.texType;
+					textureJob.imageIndex = imageIndex;
+					textureJob.fallbackImageIndex = fallbackImageIndex;
+					textureJob.packORM = slot.packORM;
+					textureJob.occlusionImageIndex = slot.occlusionImageIndex;
+					textureJob.alphaCutoff = alphaCutoff;
+				}
+
+				material.textureIndices[slot.texType] = jobIndex;
+			}
+
+			materials.push_back(material);
+		}
 	}
 
-	ScratchImage GLTFLoader::LoadFallbackNormalTexture()
+	void GLTFLoader::ExtractNodes(const fastgltf::Asset& asset, std::vector<NodeData>& nodes)
 	{
-		// Default normal pointing along +Z in tangent space
-		return Create1x1Texture(128, 128, 255);
+		nodes.resize(asset.nodes.size());
+
+		for (size_t i = 0; i < asset.nodes.size(); ++i)
+		{
+			const fastgltf::Node& node = asset.nodes[i];
+
+			nodes[i].name = node.name.data() ? node.name : "UnnamedNode";
+			nodes[i].meshIndex = node.meshIndex.has_value() ? static_cast<int32_t>(*node.meshIndex) : -1;
+			nodes[i].localMatrix = Utils::ToXMFloat4x4(fastgltf::getTransformMatrix(node));
+
+			for (auto childIndex : node.children) {
+				nodes[i].children.push_back(static_cast<int32_t>(childIndex));
+				nodes[childIndex].parentIndex = static_cast<int32_t>(i);
+			}
+		}
 	}
 
-	ScratchImage GLTFLoader::LoadFallbackEmissiveTexture()
+	void GLTFLoader::ProcessTextures(const fastgltf::Asset& asset, std::vector<TextureJob>& textureJobs, ImportReport::Recorder* report)
 	{
-		// Default: black (no emission)
-		return Create1x1Texture(0, 0, 0);
+		// hash the encoded bytes so identical images behind different image indices are found too
+		JobSystem::ParallelFor(textureJobs.size(), [&](size_t jobIndex)
+			{
+				TextureJob& textureJob = textureJobs[jobIndex];
+				if (textureJob.imageIndex.has_value())
+				{
+					std::span<const uint8_t> bytes = GetImageBytes(asset, asset.images[textureJob.imageIndex.value()]);
+					textureJob.contentHash = Utils::HashBytes(bytes.data(), bytes.size(), TextureProcessing::GetSettingsHash());
+				}
+
+				// the alpha of masked mips depends on the cutoff
+				if (textureJob.alphaCutoff > 0.0f)
+					textureJob.contentHash = Utils::HashBytes(&textureJob.alphaCutoff, sizeof(textureJob.alphaCutoff), textureJob.contentHash);
+
+				// packed ORM results depend on which channels had a source and on the occlusion image
+				if (textureJob.packORM)
+				{
+					const uint8_t sources[] = { textureJob.imageIndex != textureJob.occlusionImageIndex, textureJob.occlusionImageIndex.has_value() };
+					textureJob.contentHash = Utils::HashBytes(sources, sizeof(sources), textureJob.contentHash);
+
+					if (sources[0] && sources[1])
+					{
+						std::span<const uint8_t> occlusionBytes = GetImageBytes(asset, asset.images[textureJob.occlusionImageIndex.value()]);
+						textureJob.contentHash = Utils::HashBytes(occlusionBytes.data(), occlusionBytes.size(), textureJob.contentHash);
+					}
+				}
+			});
+
+		// resolve textures other models already uploaded and duplicates within this asset
+		std::unordered_map<uint64_t, int32_t> firstJobByKey;
+		std::vector<size_t> decodeJobs;
+		size_t cacheHits = 0;
+		for (size_t jobIndex = 0; jobIndex < textureJobs.size(); ++jobIndex)
+		{
+			TextureJob& textureJob = textureJobs[jobIndex];
+
+			// fallbacks are resolved at upload, this stage has to work without a device
+			if (!textureJob.imageIndex.has_value())
+				continue;
+
+			if ((textureJob.texture = TextureCache::Find(textureJob.contentHash, textureJob.textureType)))
+			{
+				cacheHits++;
+				continue;
+			}
+
+			auto [it, inserted] = firstJobByKey.try_emplace(TextureCache::MakeKey(textureJob.contentHash, textureJob.textureType), static_cast<int32_t>(jobIndex));
+			if (!inserted)
+			{
+				textureJob.sourceJobIndex = it->second;
+				continue;
+			}
+
+			decodeJobs.push_back(jobIndex);
+		}
+
+		// decode + mips (+ block compression) on the worker pool
+		std::atomic<uint64_t> uncompressedBytes = 0;
+		std::atomic<uint64_t> compressedBytes = 0;
+		JobSystem::ParallelFor(decodeJobs.size(), [&](size_t i)
+			{
+				TextureJob& textureJob = textureJobs[decodeJobs[i]];
+				auto decodeImage = [&](size_t imageIndex)
+				{
+					ScratchImage image = ExtractImageFromBuffer(asset, asset.images[imageIndex], textureJob.textureType);
+
+					// KTX2 is transcoded straight into its image, the other decoders hand their pixels over with one copy
+					if (report && !TextureProcessing::IsKTX2(GetImageBytes(asset, asset.images[imageIndex])))
+						report->AddCopiedBytes(image.GetPixelsSize());
+					return image;
+				};
+
+				auto decode = [&](size_t imageIndex, std::optional<size_t> fallbackImageIndex)
+				{
+					try
+					{
+						return decodeImage(imageIndex);
+					}
+					catch (const std::exception& exception)
+					{
+						if (!fallbackImageIndex.has_value())
+							throw;
+
+						PRINT("Image ", imageIndex, " failed (", exception.what(), "), using fallback image ", fallbackImageIndex.value());
+						return decodeImage(fallbackImageIndex.value());
+					}
+				};
+
+				ImportReport::ScopedStage decodeScope(report, ImportReport::STAGE_IMAGEDECODE);
+				if (textureJob.packORM)
+				{
+					const bool hasMetallicRoughness = textureJob.imageIndex != textureJob.occlusionImageIndex;
+					const bool hasOcclusion = textureJob.occlusionImageIndex.has_value();
+					ScratchImage metallicRoughness = hasMetallicRoughness ? decode(textureJob.imageIndex.value(), std::nullopt) : ScratchImage();
+					ScratchImage occlusion = hasOcclusion ? decode(textureJob.occlusionImageIndex.value(), std::nullopt) : ScratchImage();
+					textureJob.scratchImage = TextureProcessing::PackORM(hasMetallicRoughness ? &metallicRoughness : nullptr, hasOcclusion ? &occlusion : nullptr);
+					if (report)
+						report->AddCopiedBytes(textureJob.scratchImage.GetPixelsSize());
+				}
+				else
+				{
+					textureJob.scratchImage = decode(textureJob.imageIndex.value(), textureJob.fallbackImageIndex);
+				}
+
+				TextureProcessing::ApplyColorSpace(textureJob.scratchImage, textureJob.textureType);
+				decodeScope._bytes = textureJob.scratchImage.GetPixelsSize();
+				decodeScope.Stop();
+
+				ImportReport::ScopedStage mipScope(report, ImportReport::STAGE_MIPS);
+				const size_t sourceLevels = textureJob.scratchImage.GetMetadata().mipLevels;
+				TextureProcessing::GenerateMipChain(textureJob.scratchImage, textureJob.textureType, textureJob.alphaCutoff);
+				mipScope._bytes = textureJob.scratchImage.GetPixelsSize();
+				mipScope.Stop();
+
+				// a new chain starts with a copy of the top level
+				if (report && textureJob.scratchImage.GetMetadata().mipLevels != sourceLevels)
+					report->AddCopiedBytes(textureJob.scratchImage.GetImage(0, 0, 0)->slicePitch);
+
+				if (TextureProcessing::compressTextures)
+				{
+					ImportReport::ScopedStage compressionScope(report, ImportReport::STAGE_COMPRESSION);
+					uncompressedBytes += textureJob.scratchImage.GetPixelsSize();
+					const bool wasCompressed = IsCompressed(textureJob.scratchImage.GetMetadata().format);
+					TextureProcessing::CompressTexture(textureJob.scratchImage, textureJob.textureType);
+					compressedBytes += textureJob.scratchImage.GetPixelsSize();
+					compressionScope._bytes = textureJob.scratchImage.GetPixelsSize();
+
+					// encoded bands are copied into the compressed chain
+					if (report && !wasCompressed && IsCompressed(textureJob.scratchImage.GetMetadata().format))
+						report->AddCopiedBytes(textureJob.scratchImage.GetPixelsSize());
+				}
+
+				// held until UploadTextures
+				if (report)
+					report->AddStagingBytes(static_cast<int64_t>(textureJob.scratchImage.GetPixelsSize()));
+			});
+
+		PRINT("Textures: ", asset.materials.size() * Texture::TEXTURETYPE_COUNT, " material slots -> ", textureJobs.size(), " jobs | decoded: ", decodeJobs.size(), " | cache hits: ", cacheHits);
+		if (TextureProcessing::compressTextures)
+			PRINT("  block compression: ", uncompressedBytes / 1024, "KB -> ", compressedBytes / 1024, "KB");
 	}
 
-	ScratchImage GLTFLoader::LoadFallbackOcclusionTexture()
+	void GLTFLoader::UploadTextures(std::vector<TextureJob>& textureJobs, std::vector<std::shared_ptr<Texture>>& textures, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes, ImportReport::Recorder* report)
 	{
-		// Default: no occlusion
-		return Create1x1Texture(255, 255, 255);
+		textures.resize(textureJobs.size());
+		for (size_t jobIndex = 0; jobIndex < textureJobs.size(); ++jobIndex)
+		{
+			TextureJob& textureJob = textureJobs[jobIndex];
+
+			if (textureJob.texture)
+				textures[jobIndex] = textureJob.texture;
+			else if (!textureJob.imageIndex.has_value())
+				textures[jobIndex] = TextureCache::GetFallbackTexture(textureJob.textureType);
+			else if (textureJob.sourceJobIndex != NOTOK)
+				textures[jobIndex] = textures[textureJob.sourceJobIndex];
+			else
+			{
+				uploadBytes += textureJob.scratchImage.GetPixelsSize();
+				std::shared_ptr<Texture> texture = std::make_shared<Texture>(commandList, textureJob.textureType, textureJob.scratchImage);
+
+				// the pixels live in the upload heap now
+				if (GLTFLoader::releaseStagingCopies)
+				{
+					if (report)
+						report->AddStagingBytes(-static_cast<int64_t>(textureJob.scratchImage.GetPixelsSize()));
+					textureJob.scratchImage.Release();
+				}
+				else
+				{
+					texture->RetainImage(std::move(textureJob.scratchImage));
+				}
+
+				textures[jobIndex] = TextureCache::Insert(textureJob.contentHash, textureJob.textureType, texture);
+			}
+		}
 	}
 
-	void GLTFLoader::GenerateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+	std::span<const uint8_t> GLTFLoader::GetImageBytes(const fastgltf::Asset& asset, const fastgltf::Image& assetImage)
 	{
-		std::vector<XMFLOAT3> accumulatedTan(vertices.size(), XMFLOAT3(0, 0, 0));
-		std::vector<XMFLOAT3> accumulatedBitan(vertices.size(), XMFLOAT3(0, 0, 0));
+		if (auto bufferViewPtr = std::get_if<fastgltf::sources::BufferView>(&assetImage.data))
+		{
+			const fastgltf::sources::BufferView& view = *bufferViewPtr;
+			const auto& bufferViewMeta = asset.bufferViews[view.bufferViewIndex];
+			std::span<const uint8_t> bufferBytes = GetBufferBytes(asset.buffers[bufferViewMeta.bufferIndex]);
 
-		for (size_t i = 0; i < indices.size(); i += 3) {
-			uint32_t i0 = indices[i + 0];
-			uint32_t i1 = indices[i + 1];
-			uint32_t i2 = indices[i + 2];
+			if (bufferViewMeta.byteOffset + bufferViewMeta.byteLength <= bufferBytes.size())
+				return bufferBytes.subspan(bufferViewMeta.byteOffset, bufferViewMeta.byteLength);
+		}
 
-			const XMFLOAT3& p0 = vertices[i0].position;
-			const XMFLOAT3& p1 = vertices[i1].position;
-			const XMFLOAT3& p2 = vertices[i2].position;
+		return {};
+	}
 
-			const XMFLOAT2& uv0 = vertices[i0].uv;
-			const XMFLOAT2& uv1 = vertices[i1].uv;
-			const XMFLOAT2& uv2 = vertices[i2].uv;
+	ScratchImage GLTFLoader::ExtractImageFromBuffer(const fastgltf::Asset& asset, const fastgltf::Image& assetImage, Texture::TEXTURETYPE texType)
+	{
+		std::span<const uint8_t> pixelData = GetImageBytes(asset, assetImage);
+		if (pixelData.empty())
+			ThrowException("no pixeldata while loading image");
 
-			XMVECTOR v0 = XMLoadFloat3(&p0);
-			XMVECTOR v1 = XMLoadFloat3(&p1);
-			XMVECTOR v2 = XMLoadFloat3(&p2);
+		if (TextureProcessing::IsKTX2(pixelData))
+			return TextureProcessing::TranscodeKTX2(pixelData, texType);
 
-			XMVECTOR edge1 = XMVectorSubtract(v1, v0);
-			XMVECTOR edge2 = XMVectorSubtract(v2, v0);
+		// WIC stays as fallback for what stb_image does not read (e.g. WebP through an installed codec)
+		try
+		{
+			return TextureProcessing::DecodeImage(pixelData);
+		}
+		catch (const std::exception& exception)
+		{
+			PRINT("stb_image could not decode image (", exception.what(), "), trying WIC");
+			ScratchImage scratchImage;
+			ThrowIfFailed(LoadFromWICMemory(pixelData.data(), pixelData.size(), WIC_FLAGS_NONE, nullptr, scratchImage));
+			return scratchImage;
+		}
+	}
 
-			float du1 = uv1.x - uv0.x;
-			float dv1 = uv1.y - uv0.y;
-			float du2 = uv2.x - uv0.x;
-			float dv2 = uv2.y - uv0.y;
+	// accessor whose elements can be read straight out of its buffer: no sparse substitution, no normalization or conversion
+	struct DirectAccessor
+	{
+		const uint8_t* data = nullptr;
+		size_t stride = 0;
+	};
 
-			float det = du1 * dv2 - du2 * dv1;
-			if (fabs(det) < 1e-6f) det = 1.0f;
-			float invDet = 1.0f / det;
+	DirectAccessor GetDirectAccessor(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, fastgltf::AccessorType type, fastgltf::ComponentType componentType)
+	{
+		if (accessor.type != type || accessor.componentType != componentType || accessor.normalized || accessor.sparse.has_value() || !accessor.bufferViewIndex.has_value() || accessor.count == 0)
+			return {};
 
-			XMVECTOR tangent = XMVectorScale(
-				XMVectorSubtract(
-					XMVectorScale(edge1, dv2),
-					XMVectorScale(edge2, dv1)
-				), invDet
-			);
+		const fastgltf::BufferView& bufferView = asset.bufferViews[accessor.bufferViewIndex.value()];
+		std::span<const uint8_t> bufferBytes = GLTFLoader::GetBufferBytes(asset.buffers[bufferView.bufferIndex]);
+		if (bufferView.byteOffset + bufferView.byteLength > bufferBytes.size())
+			return {};
 
-			XMVECTOR bitangent = XMVectorScale(
-				XMVectorSubtract(
-					XMVectorScale(edge2, du1),
-					XMVectorScale(edge1, du2)
-				), invDet
-			);
+		const size_t elementSize = fastgltf::getElementByteSize(type, componentType);
+		const size_t stride = bufferView.byteStride.has_value() ? bufferView.byteStride.value() : elementSize;
+		if (accessor.byteOffset + stride * (accessor.count - 1) + elementSize > bufferView.byteLength)
+			return {};
 
-			XMFLOAT3 t, b;
-			XMStoreFloat3(&t, tangent);
-			XMStoreFloat3(&b, bitangent);
+		return { bufferBytes.data() + bufferView.byteOffset + accessor.byteOffset, stride };
+	}
 
-			accumulatedTan[i0].x += t.x; accumulatedTan[i0].y += t.y; accumulatedTan[i0].z += t.z;
-			accumulatedTan[i1].x += t.x; accumulatedTan[i1].y += t.y; accumulatedTan[i1].z += t.z;
-			accumulatedTan[i2].x += t.x; accumulatedTan[i2].y += t.y; accumulatedTan[i2].z += t.z;
+	// tightly packed 32 bit indices are one copy, narrower ones a widening loop with a constant stride the compiler vectorizes
+	template <typename IndexType>
+	void CopyIndices(const DirectAccessor& source, std::vector<uint32_t>& indices)
+	{
+		if constexpr (sizeof(IndexType) == sizeof(uint32_t))
+		{
+			if (source.stride == sizeof(uint32_t))
+			{
+				memcpy(indices.data(), source.data, indices.size() * sizeof(uint32_t));
+				return;
+			}
+		}
 
-			accumulatedBitan[i0].x += b.x; accumulatedBitan[i0].y += b.y; accumulatedBitan[i0].z += b.z;
-			accumulatedBitan[i1].x += b.x; accumulatedBitan[i1].y += b.y; accumulatedBitan[i1].z += b.z;
-			accumulatedBitan[i2].x += b.x; accumulatedBitan[i2].y += b.y; accumulatedBitan[i2].z += b.z;
+		IndexType index = 0;
+		if (source.stride == sizeof(IndexType))
+		{
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				memcpy(&index, source.data + i * sizeof(IndexType), sizeof(IndexType));
+				indices[i] = index;
+			}
+			return;
 		}
 
-		for (size_t i = 0; i < vertices.size(); ++i) {
-			XMVECTOR N = XMVector3Normalize(XMLoadFloat3(&vertices[i].normal));
-			XMVECTOR T = XMLoadFloat3(&accumulatedTan[i]);
-			XMVECTOR B = XMLoadFloat3(&accumulatedBitan[i]);
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			memcpy(&index, source.data + i * source.stride, sizeof(IndexType));
+			indices[i] = index;
+		}
+	}
 
-			// Orthonormalize T with respect to N
-			T = XMVector3Normalize(XMVectorSubtract(T, XMVectorScale(N, XMVector3Dot(N, T).m128_f32[0])));
+	// per element conversion through the accessor tools, handles every accessor (normalized, quantized, sparse)
+	void ReadIndicesPerElement(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<uint32_t>& indices)
+	{
+		fastgltf::iterateAccessorWithIndex<std::uint32_t>(asset, accessor, [&](std::uint32_t index, std::size_t idx) {
+			indices[idx] = index;
+			});
+	}
 
-			// Calculate handedness
-			float handedness = (XMVector3Dot(XMVector3Cross(N, T), B).m128_f32[0] < 0.0f) ? -1.0f : 1.0f;
+	template <typename ElementType, typename MemberType>
+	void ReadAttributePerElement(const fastgltf::Asset& asset, const fastgltf::Accessor& accessor, std::vector<Vertex>& vertices, MemberType Vertex::* member)
+	{
+		static_assert(sizeof(ElementType) == sizeof(MemberType), "accessor element and vertex attribute differ in size");
+
+		fastgltf::iterateAccessorWithIndex<ElementType>(asset, accessor, [&](ElementType value, std::size_t idx) {
+			memcpy(&(vertices[idx].*member), &value, sizeof(MemberType));
+			});
+	}
 
-			XMFLOAT3 tangent;
-			XMStoreFloat3(&tangent, T);
-			vertices[i].tangent = XMFLOAT4(tangent.x, tangent.y, tangent.z, handedness);
+	// the previous extraction: one accessor tool callback per element and attribute. Only kept as benchmark baseline
+	void ExtractVerticesPerElement(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<Vertex>& vertices)
+	{
+		vertices.resize(asset.accessors[primitive.findAttribute("POSITION")->accessorIndex].count);
+
+		ReadAttributePerElement<fastgltf::math::fvec3>(asset, asset.accessors[primitive.findAttribute("POSITION")->accessorIndex], vertices, &Vertex::position);
+		if (auto it = primitive.findAttribute("NORMAL"); it != primitive.attributes.end())
+			ReadAttributePerElement<fastgltf::math::fvec3>(asset, asset.accessors[it->accessorIndex], vertices, &Vertex::normal);
+		if (auto it = primitive.findAttribute("TEXCOORD_0"); it != primitive.attributes.end())
+			ReadAttributePerElement<fastgltf::math::fvec2>(asset, asset.accessors[it->accessorIndex], vertices, &Vertex::uv);
+		if (auto it = primitive.findAttribute("TANGENT"); it != primitive.attributes.end())
+			ReadAttributePerElement<fastgltf::math::fvec4>(asset, asset.accessors[it->accessorIndex], vertices, &Vertex::tangent);
+	}
+
+	void GLTFLoader::ExtractIndices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<uint32_t>& indices)
+	{
+		// unindexed primitives draw their vertices in order
+		if (!primitive.indicesAccessor.has_value())
+		{
+			indices.resize(asset.accessors[primitive.findAttribute("POSITION")->accessorIndex].count);
+			std::iota(indices.begin(), indices.end(), 0u);
+			return;
 		}
+
+		const fastgltf::Accessor& indexAccessor = asset.accessors[primitive.indicesAccessor.value()];
+		indices.resize(indexAccessor.count);
+
+		const DirectAccessor source = GetDirectAccessor(asset, indexAccessor, fastgltf::AccessorType::Scalar, indexAccessor.componentType);
+		if (source.data && indexAccessor.componentType == fastgltf::ComponentType::UnsignedInt)
+			CopyIndices<uint32_t>(source, indices);
+		else if (source.data && indexAccessor.componentType == fastgltf::ComponentType::UnsignedShort)
+			CopyIndices<uint16_t>(source, indices);
+		else if (source.data && indexAccessor.componentType == fastgltf::ComponentType::UnsignedByte)
+			CopyIndices<uint8_t>(source, indices);
+		else
+			ReadIndicesPerElement(asset, indexAccessor, indices);
 	}
 
-	void GLTFLoader::GenerateBiTangents(std::vector<Vertex>& vertices)
+	void GLTFLoader::ExtractVertices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<Vertex>& vertices, bool& generateTangents)
 	{
-		for (size_t i = 0; i < vertices.size(); ++i) {
-			XMVECTOR N = XMLoadFloat3(&vertices[i].normal);
-			XMVECTOR T = { vertices[i].tangent.x, vertices[i].tangent.y, vertices[i].tangent.z, 0.0f };
+		const fastgltf::Accessor& positionAccessor = asset.accessors[primitive.findAttribute("POSITION")->accessorIndex];
+		const size_t vertexCount = positionAccessor.count;
+		vertices.resize(vertices.size() + vertexCount);
 
-			XMVECTOR B = XMVector3Normalize(XMVector3Cross(N, T) * vertices[i].tangent.w);
+		auto findAccessor = [&](std::string_view attributeName) -> const fastgltf::Accessor*
+		{
+			auto it = primitive.findAttribute(attributeName);
+			return it != primitive.attributes.end() ? &asset.accessors[it->accessorIndex] : nullptr;
+		};
+		const fastgltf::Accessor* normalAccessor = findAccessor("NORMAL");
+		const fastgltf::Accessor* uvAccessor = findAccessor("TEXCOORD_0");
+		const fastgltf::Accessor* tangentAccessor = findAccessor("TANGENT");
+
+		if (!tangentAccessor)
+			generateTangents = true;
+
+		// plain float accessors are read straight from their buffers and interleaved in one pass that writes every vertex once,
+		// the rest (KHR_mesh_quantization, sparse) is converted per element afterwards
+		auto directFloats = [&](const fastgltf::Accessor* accessor, fastgltf::AccessorType type)
+		{
+			return accessor && accessor->count >= vertexCount ? GetDirectAccessor(asset, *accessor, type, fastgltf::ComponentType::Float) : DirectAccessor();
+		};
+		const DirectAccessor position = directFloats(&positionAccessor, fastgltf::AccessorType::Vec3);
+		const DirectAccessor normal = directFloats(normalAccessor, fastgltf::AccessorType::Vec3);
+		const DirectAccessor uv = directFloats(uvAccessor, fastgltf::AccessorType::Vec2);
+		const DirectAccessor tangent = directFloats(tangentAccessor, fastgltf::AccessorType::Vec4);
+
+		// fixed size copies become unaligned vector loads/stores, the branches never change inside the loop
+		if (position.data || normal.data || uv.data || tangent.data)
+		{
+			for (size_t i = 0; i < vertexCount; ++i)
+			{
+				Vertex& vertex = vertices[i];
+				if (position.data)
+					memcpy(&vertex.position, position.data + i * position.stride, sizeof(XMFLOAT3));
+				if (normal.data)
+					memcpy(&vertex.normal, normal.data + i * normal.stride, sizeof(XMFLOAT3));
+				if (uv.data)
+					memcpy(&vertex.uv, uv.data + i * uv.stride, sizeof(XMFLOAT2));
+				if (tangent.data)
+					memcpy(&vertex.tangent, tangent.data + i * tangent.stride, sizeof(XMFLOAT4));
+			}
+		}
+
+		if (!position.data)
+			ReadAttributePerElement<fastgltf::math::fvec3>(asset, positionAccessor, vertices, &Vertex::position);
+		if (normalAccessor && !normal.data)
+			ReadAttributePerElement<fastgltf::math::fvec3>(asset, *normalAccessor, vertices, &Vertex::normal);
+		if (uvAccessor && !uv.data)
+			ReadAttributePerElement<fastgltf::math::fvec2>(asset, *uvAccessor, vertices, &Vertex::uv);
+		if (tangentAccessor && !tangent.data)
+			ReadAttributePerElement<fastgltf::math::fvec4>(asset, *tangentAccessor, vertices, &Vertex::tangent);
+	}
+
+	void GLTFLoader::BenchmarkAccessorExtraction(const std::filesystem::path& path, uint32_t repeatCount)
+	{
+		fastgltf::Asset asset;
+		if (!ParseAsset(path, asset))
+			return;
+
+		// every primitive of the asset repeatCount times, extraction only (no welding, tangents or optimization)
+		std::vector<const fastgltf::Primitive*> jobs;
+		for (uint32_t i = 0; i < repeatCount; ++i)
+			for (const fastgltf::Mesh& mesh : asset.meshes)
+				for (const fastgltf::Primitive& primitive : mesh.primitives)
+					jobs.push_back(&primitive);
+
+		std::vector<PrimitiveData> perElementResults(jobs.size());
+		std::vector<PrimitiveData> bulkResults(jobs.size());
+
+		Utils::Timer::StartTimer();
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			const fastgltf::Primitive& primitive = *jobs[i];
+			if (primitive.indicesAccessor.has_value())
+			{
+				perElementResults[i].indices.resize(asset.accessors[primitive.indicesAccessor.value()].count);
+				ReadIndicesPerElement(asset, asset.accessors[primitive.indicesAccessor.value()], perElementResults[i].indices);
+			}
+			else
+			{
+				ExtractIndices(asset, primitive, perElementResults[i].indices);
+			}
+			ExtractVerticesPerElement(asset, primitive, perElementResults[i].vertices);
+		}
+		double perElementMs = Utils::Timer::GetElapsedMilliseconds();
+
+		Utils::Timer::StartTimer();
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			bool generateTangents = false;
+			ExtractIndices(asset, *jobs[i], bulkResults[i].indices);
+			ExtractVertices(asset, *jobs[i], bulkResults[i].vertices, generateTangents);
+		}
+		double bulkMs = Utils::Timer::GetElapsedMilliseconds();
+
+		bool identical = true;
+		uint64_t extractedBytes = 0;
+		for (size_t i = 0; i < jobs.size(); ++i)
+		{
+			const PrimitiveData& a = perElementResults[i];
+			const PrimitiveData& b = bulkResults[i];
+			identical = identical && a.indices == b.indices
+				&& a.vertices.size() == b.vertices.size()
+				&& memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(Vertex)) == 0;
+			extractedBytes += b.vertices.size() * sizeof(Vertex) + b.indices.size() * sizeof(uint32_t);
+		}
+
+		const double extractedMB = static_cast<double>(extractedBytes) / (1024.0 * 1024.0);
+		PRINT("Accessor extraction benchmark: ", path.filename().string(), " | primitives: ", jobs.size(), " | ", extractedMB, "MB extracted");
+		PRINT("  per element: ", perElementMs, "ms (", extractedMB / std::max(perElementMs, 0.001) * 1000.0, "MB/s)");
+		PRINT("  bulk:        ", bulkMs, "ms (", extractedMB / std::max(bulkMs, 0.001) * 1000.0, "MB/s, ", perElementMs / std::max(bulkMs, 0.001), "x)");
+		PRINT("  output identical: ", identical ? "yes" : "NO");
+	}
+
+	ScratchImage GLTFLoader::Create1x1Texture(uint8_t r, uint8_t g, uint8_t b, uint8_t a)
+	{
+		ScratchImage image;
+		image.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, 1, 1, 1, 1);
+		uint8_t* pixels = image.GetImage(0, 0, 0)->pixels;
+		pixels[0] = r;
+		pixels[1] = g;
+		pixels[2] = b;
+		pixels[3] = a;
+		return image;
+	}
 
-			XMFLOAT3 biTangent;
-			XMStoreFloat3(&biTangent, B);
-			vertices[i].bitangent = XMFLOAT3(biTangent.x, biTangent.y, biTangent.z);
+	ScratchImage GLTFLoader::LoadFallbackTexture(Texture::TEXTURETYPE texType)
+	{
+		switch (texType)
+		{
+		case Texture::TEXTURETYPE::TEXTURE_ALBEDO:
+			return LoadFallbackAlbedoTexture();
+		case Texture::TEXTURETYPE::TEXTURE_ORM:
+			return LoadFallbackORMTexture();
+		case Texture::TEXTURETYPE::TEXTURE_NORMAL:
+			return LoadFallbackNormalTexture();
+		case Texture::TEXTURETYPE::TEXTURE_EMISSIVE:
+		default:
+			return LoadFallbackEmissiveTexture();
 		}
 	}
+
+	ScratchImage GLTFLoader::LoadFallbackAlbedoTexture()
+	{
+		// Default albedo: mid-gray (e.g., base color = 0.5)
+		return Create1x1Texture(255, 0, 200, 120);
+	}
+
+	ScratchImage GLTFLoader::LoadFallbackORMTexture()
+	{
+		// Default: no occlusion (255), fully rough (255), non-metal (0)
+		// R = Occlusion, G = Roughness, B = Metallic
+		return Create1x1Texture(255, 255, 0);
+	}
+
+	ScratchImage GLTFLoader::LoadFallbackNormalTexture()
+	{
+		// Default normal pointing along +Z in tangent space
+		return Create1x1Texture(128, 128, 255);
+	}
+
+	ScratchImage GLTFLoader::LoadFallbackEmissiveTexture()
+	{
+		// Default: black (no emission)
+		return Create1x1Texture(0, 0, 0);
+	}
 }
@@ -2,26 +2,126 @@
 
 #include "pch.h"
 
+#include <map>
+#include <atomic>
+#include <mutex>
+
 #include "Model.h"
+#include "CommandContext.h"
+#include "JobSystem.h"
+#include "TextureCache.h"
+#include "ModelData.h"
+#include "DerivedDataCache.h"
+#include "MeshProcessing.h"
+#include "TextureProcessing.h"
+#include "ImportReport.h"
+#include "ImportArena.h"
 
 namespace GLTFLoader
 {
-	bool ConstructModelFromFile(const std::filesystem::path& path, std::shared_ptr<Model>& model, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
+	// one visible step of a progressive load. Its uploads are submitted, the stage can be shown once fenceValue is reached
+	// on the upload queue and every texture of the model is resident
+	struct ModelStage
+	{
+		std::string name;
+		std::shared_ptr<Model> model;
+		std::shared_ptr<CommandContext> uploadContext; // kept alive until the stage is shown
+		uint64_t fenceValue = 0;
+		uint64_t uploadBytes = 0;
+		bool isFinal = false;
+	};
+
+	// final stages of several loads recorded into one upload context and submitted with one fence (see
+	// ModelManager::LoadModels). Parsing and processing of the loads still overlap, only the recording is serialized
+	struct UploadBatch
+	{
+		std::shared_ptr<CommandContext> uploadContext;
+		std::mutex recordMutex;
+	};
+
+	// called on the loading thread, in order, for every stage that was submitted (recorded, with a batch)
+	using StageCallback = std::function<void(ModelStage&& stage)>;
+	using StageRecorder = std::function<std::shared_ptr<Model>(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)>;
+	// maxSize > 0 limits the upload to the mips that fit
+	using PackageTextureSource = std::function<bool(uint32_t textureIndex, const ModelPackage::TextureView& textureView, uint32_t maxSize, std::shared_ptr<Texture>& texture, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes)>;
+	using GeometryCallback = std::function<void(const ModelData& modelData)>;
+
+	// cache hit -> stages of the mapped entry, otherwise the import runs (geometry stage before the textures are decoded)
+	// and its result is stored. With a report every stage of the load is timed into it, with a batch only the final stage
+	// is recorded into it and nothing is submitted
+	bool StreamModelFromFile(const std::filesystem::path& path, const StageCallback& onStage, ImportReport::Recorder* report = nullptr, UploadBatch* batch = nullptr);
+	bool StreamModelFromCache(const std::filesystem::path& path, uint64_t sourceHash, const StageCallback& onStage, ImportReport::Recorder* report = nullptr, UploadBatch* batch = nullptr);
+
+	// cooked packages (artisDX-cook), pure I/O: geometry and mips are uploaded from the mapped file
+	bool StreamModelFromPackage(const std::filesystem::path& path, const StageCallback& onStage, ImportReport::Recorder* report = nullptr, UploadBatch* batch = nullptr);
+	// with progressiveStreaming (and no batch) a coarse stage (coarsest lod, mips up to coarseTextureSize) comes before the full one
+	bool StreamModelView(const std::string& name, const ModelPackage::ModelView& view, const PackageTextureSource& textureSource, const StageCallback& onStage, ImportReport::Recorder* report = nullptr, UploadBatch* batch = nullptr);
+	// records one stage into its own upload context and submits it, failed stages are submitted but not passed on (the
+	// TextureCache holds what they recorded until the copies ran).
+	// With a batch the stage is recorded into the shared context and passed on without a fence
+	bool RecordStage(const std::string& stageName, bool isFinal, const StageRecorder& record, const StageCallback& onStage, ImportReport::Recorder* report = nullptr, UploadBatch* batch = nullptr);
+	// submits everything recorded into the batch and hands its fence to the stages and to the textures recorded into it
+	uint64_t SubmitUploadBatch(UploadBatch& batch, std::span<ModelStage> stages);
+	// textures of the stage recorded in recordingId become resident with its fence, textures found in the cache keep
+	// the fence of the stage that recorded them
+	void AssignUploadFence(const ModelStage& stage, uint64_t recordingId);
+	// last level of the primitive as a single level primitive, only with the vertices it references
+	PrimitiveData ExtractCoarsestLod(const PrimitiveView& view);
+	bool UploadPackageTexture(const PackageReader& reader, uint32_t textureIndex, const ModelPackage::TextureView& textureView, uint32_t maxSize, std::shared_ptr<Texture>& texture, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes);
+	bool WriteModelPackage(const ModelData& modelData, const std::filesystem::path& path, uint64_t* writtenBytes = nullptr);
 
+	// CPU only, needs no device
+	// onGeometry sees the model with meshes, materials and nodes but before the textures are decoded
+	bool ImportModelData(const std::filesystem::path& path, ModelData& modelData, const GeometryCallback& onGeometry = nullptr, ImportReport::Recorder* report = nullptr);
+	bool ParseAsset(const std::filesystem::path& path, fastgltf::Asset& asset, ImportReport::Recorder* report = nullptr);
+	// EXT_meshopt_compression: every compressed buffer view is decoded (in parallel) into a buffer of its own and
+	// pointed at it, so everything after parsing reads plain accessors
+	bool DecodeCompressedBufferViews(fastgltf::Asset& asset, ImportReport::Recorder* report = nullptr);
+	// KHR_draco_mesh_compression: every compressed primitive is decoded (in parallel) into a buffer of its own and its
+	// accessors are pointed at it, the same way
+	bool DecodeDracoPrimitives(fastgltf::Asset& asset, ImportReport::Recorder* report = nullptr);
+	// bytes of a buffer loaded while parsing, empty (with the reason in error) for buffers that carry none
+	std::span<const uint8_t> GetBufferBytes(const fastgltf::Buffer& buffer, std::string* error = nullptr);
+
+	std::vector<std::vector<PrimitiveView>> MakePrimitiveViews(const std::vector<std::vector<PrimitiveData>>& meshPrimitives);
+	// single level primitives already uploaded by an earlier stage of the same model (residentMeshes) are shared
+	std::vector<Mesh> CreateMeshes(const std::vector<std::vector<PrimitiveView>>& meshViews, uint64_t& uploadBytes, const std::vector<Mesh>& residentMeshes = {});
+	// textures are already resolved and indexed like MaterialData::textureIndices
+	std::shared_ptr<Model> AssembleModel(const std::string& name, std::vector<Mesh> meshes, const std::vector<MaterialData>& materialData, std::vector<std::shared_ptr<Texture>> textures, const std::vector<NodeData>& nodeData);
+
+	void ExtractPrimitives(const fastgltf::Asset& asset, std::vector<std::vector<PrimitiveData>>& meshPrimitives, MeshProcessing::OptimizationStatistics* statistics = nullptr, ImportReport::Recorder* report = nullptr);
+	PrimitiveData ProcessPrimitive(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, MeshProcessing::OptimizationStatistics* statistics = nullptr, ImportReport::Recorder* report = nullptr);
+	void ExtractMaterials(const fastgltf::Asset& asset, std::vector<MaterialData>& materials, std::vector<TextureJob>& textureJobs);
+	void ExtractNodes(const fastgltf::Asset& asset, std::vector<NodeData>& nodes);
+	void ProcessTextures(const fastgltf::Asset& asset, std::vector<TextureJob>& textureJobs, ImportReport::Recorder* report = nullptr);
+	void UploadTextures(std::vector<TextureJob>& textureJobs, std::vector<std::shared_ptr<Texture>>& textures, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint64_t& uploadBytes, ImportReport::Recorder* report = nullptr);
+
+	// plain accessors are copied straight out of their buffers, everything else goes through the fastgltf accessor tools
 	void ExtractIndices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<uint32_t>& indices);
 	void ExtractVertices(const fastgltf::Asset& asset, const fastgltf::Primitive& primitive, std::vector<Vertex>& vertices, bool& generateTangents);
-	void GenerateTangents(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
-	void GenerateBiTangents(std::vector<Vertex>& vertices);
 
-	ScratchImage ExtractImageFromBuffer(const fastgltf::Asset& asset, const fastgltf::Image& assetImage);
+	std::span<const uint8_t> GetImageBytes(const fastgltf::Asset& asset, const fastgltf::Image& assetImage);
+	// KTX2 is transcoded, PNG/JPEG decoded with TextureProcessing::DecodeImage, WIC (Windows only) takes the rest
+	ScratchImage ExtractImageFromBuffer(const fastgltf::Asset& asset, const fastgltf::Image& assetImage, Texture::TEXTURETYPE texType);
 
+	ScratchImage LoadFallbackTexture(Texture::TEXTURETYPE texType);
 	ScratchImage LoadFallbackAlbedoTexture();
-	ScratchImage LoadFallbackMetallicRoughnessTexture();
+	ScratchImage LoadFallbackORMTexture();
 	ScratchImage LoadFallbackNormalTexture();
 	ScratchImage LoadFallbackEmissiveTexture();
-	ScratchImage LoadFallbackOcclusionTexture();
 	ScratchImage Create1x1Texture(uint8_t r, uint8_t g, uint8_t b, uint8_t a = 255);
 
-	extern fastgltf::Parser parser;
-	extern int32_t modelIdIncrementor;
+	void BenchmarkGeometryExtraction(const std::filesystem::path& path, uint32_t repeatCount);
+	// bulk accessor copies against the per element accessor tools, on every primitive of the asset repeatCount times
+	void BenchmarkAccessorExtraction(const std::filesystem::path& path, uint32_t repeatCount);
+
+	// one parser per thread, models load in the background and a Parser is not safe to share
+	extern thread_local fastgltf::Parser parser;
+	extern std::atomic<int32_t> modelIdIncrementor;
+	extern bool parallelExtraction;
+	extern bool progressiveStreaming;
+	extern uint32_t coarseTextureSize;
+	// CPU copies are dropped once they are in the upload heap, and the upload heaps once the textures are resident.
+	// Off keeps the previous retention (images and upload heaps live as long as their texture) to measure against
+	extern bool releaseStagingCopies;
 }
@@ -0,0 +1,131 @@
+#include "ImageDecoder.h"
+
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+	// stb_image always returns a buffer it allocated itself, sized exactly like the decoded image. The first allocation
+	// of that size gets the caller's memory instead. A temporary of the same size that stb frees again hands it back, and
+	// a result that ended up somewhere else is copied, so the pixels are right either way
+	struct DecodeTarget
+	{
+		uint8_t* pixels = nullptr;
+		size_t size = 0;
+		bool claimed = false;
+	};
+	thread_local DecodeTarget decodeTarget;
+
+	void* Allocate(size_t size)
+	{
+		if (decodeTarget.pixels && !decodeTarget.claimed && size == decodeTarget.size)
+		{
+			decodeTarget.claimed = true;
+			return decodeTarget.pixels;
+		}
+		return std::malloc(size);
+	}
+
+	void* Reallocate(void* memory, size_t size)
+	{
+		if (!memory || memory != decodeTarget.pixels)
+			return std::realloc(memory, size);
+
+		if (size <= decodeTarget.size)
+			return memory;
+
+		void* grown = std::malloc(size);
+		if (grown)
+		{
+			memcpy(grown, memory, decodeTarget.size);
+			decodeTarget.claimed = false;
+		}
+		return grown;
+	}
+
+	void Free(void* memory)
+	{
+		if (memory && memory == decodeTarget.pixels)
+			decodeTarget.claimed = false;
+		else
+			std::free(memory);
+	}
+
+	bool Fail(std::string* error, const std::string& reason)
+	{
+		if (error)
+			*error = reason;
+		return false;
+	}
+}
+
+#define STBI_MALLOC(size) Allocate(size)
+#define STBI_REALLOC(memory, size) Reallocate(memory, size)
+#define STBI_FREE(memory) Free(memory)
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_PNG
+#define STBI_ONLY_JPEG
+#define STBI_NO_STDIO
+#if defined(_M_ARM64) || defined(__ARM_NEON)
+#define STBI_NEON
+#endif
+#include <stb_image.h>
+
+namespace ImageDecoder
+{
+	bool ReadInfo(std::span<const uint8_t> bytes, ImageInfo& info, std::string* error)
+	{
+		if (bytes.size() > static_cast<size_t>(INT_MAX))
+			return Fail(error, "image too large to decode");
+
+		const int size = static_cast<int>(bytes.size());
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		if (!stbi_info_from_memory(bytes.data(), size, &width, &height, &channels) || width <= 0 || height <= 0)
+			return Fail(error, std::string("image decoding failed: ") + stbi_failure_reason());
+
+		info.width = static_cast<uint32_t>(width);
+		info.height = static_cast<uint32_t>(height);
+		info.sixteenBit = stbi_is_16_bit_from_memory(bytes.data(), size) != 0;
+		return true;
+	}
+
+	bool Decode(std::span<const uint8_t> bytes, const ImageInfo& info, uint8_t* pixels, size_t rowPitch, std::string* error)
+	{
+		if (bytes.size() > static_cast<size_t>(INT_MAX))
+			return Fail(error, "image too large to decode");
+
+		const size_t rowBytes = info.GetRowBytes();
+		if (rowPitch < rowBytes)
+			return Fail(error, "row pitch smaller than a row of the image");
+
+		decodeTarget = { rowPitch == rowBytes ? pixels : nullptr, rowBytes * info.height, false };
+
+		const int size = static_cast<int>(bytes.size());
+		int width = 0;
+		int height = 0;
+		int channels = 0;
+		void* decoded = info.sixteenBit
+			? static_cast<void*>(stbi_load_16_from_memory(bytes.data(), size, &width, &height, &channels, 4))
+			: static_cast<void*>(stbi_load_from_memory(bytes.data(), size, &width, &height, &channels, 4));
+
+		decodeTarget = {};
+
+		if (!decoded)
+			return Fail(error, std::string("image decoding failed: ") + stbi_failure_reason());
+
+		if (decoded == pixels)
+			return true;
+
+		const bool matches = static_cast<uint32_t>(width) == info.width && static_cast<uint32_t>(height) == info.height;
+		if (matches)
+			for (size_t y = 0; y < info.height; ++y)
+				memcpy(pixels + y * rowPitch, static_cast<const uint8_t*>(decoded) + y * rowBytes, rowBytes);
+
+		stbi_image_free(decoded);
+		return matches || Fail(error, "image size differs from its header");
+	}
+}
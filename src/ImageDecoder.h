@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// PNG/JPEG decoding through stb_image into memory the caller owns. Plain pixel buffers and error strings only, no
+// Windows or DirectXTex types, so the headless asset tools build it on every platform (see TextureProcessing::DecodeImage
+// for the ScratchImage side). It keeps no shared state, images are decoded on all workers at once
+namespace ImageDecoder
+{
+	struct ImageInfo
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		bool sixteenBit = false; // RGBA16 (16 bit PNGs), RGBA8 otherwise
+
+		size_t GetRowBytes() const { return static_cast<size_t>(width) * (sixteenBit ? 8 : 4); }
+	};
+
+	// header only, sizes the destination of Decode
+	bool ReadInfo(std::span<const uint8_t> bytes, ImageInfo& info, std::string* error = nullptr);
+	// RGBA8/RGBA16 rows of info.GetRowBytes() at rowPitch. With a tight pitch stb_image decodes straight into pixels,
+	// otherwise its rows are copied over once
+	bool Decode(std::span<const uint8_t> bytes, const ImageInfo& info, uint8_t* pixels, size_t rowPitch, std::string* error = nullptr);
+}
@@ -0,0 +1,184 @@
+#include "ImportArena.h"
+
+#include "meshoptimizer.h"
+
+namespace ImportArena
+{
+	bool enabled = true;
+	size_t chunkSize = 4 * 1024 * 1024;
+	size_t maxRetainedBytes = 64 * 1024 * 1024;
+
+	// created on first use, one per worker
+	thread_local std::unique_ptr<Arena> threadArena;
+	thread_local CountingResource countingResource;
+	thread_local Statistics statistics;
+	thread_local uint32_t scopeDepth = 0;
+
+	constexpr size_t chunkAlignment = 64;
+
+	// meshoptimizer frees through a plain pointer, the header remembers where the block came from
+	struct alignas(16) AllocationHeader
+	{
+		std::pmr::memory_resource* resource = nullptr;
+		size_t size = 0;
+	};
+
+	Arena& GetThreadArena()
+	{
+		if (!threadArena)
+			threadArena = std::make_unique<Arena>();
+		return *threadArena;
+	}
+
+	Arena::~Arena()
+	{
+		FreeChunks();
+	}
+
+	void Arena::Rewind()
+	{
+		size_t capacity = 0;
+		for (const Chunk& chunk : _chunks)
+			capacity += chunk.size;
+
+		if (_chunks.size() > 1 || capacity > ImportArena::maxRetainedBytes)
+		{
+			FreeChunks();
+			_mergedChunkSize = capacity <= ImportArena::maxRetainedBytes ? capacity : 0;
+		}
+
+		_chunkIndex = 0;
+		_offset = 0;
+	}
+
+	void* Arena::do_allocate(size_t bytes, size_t alignment)
+	{
+		bytes = std::max<size_t>(bytes, 1);
+		while (true)
+		{
+			if (_chunkIndex < _chunks.size())
+			{
+				Chunk& chunk = _chunks[_chunkIndex];
+				size_t aligned = (_offset + alignment - 1) & ~(alignment - 1);
+				if (aligned + bytes <= chunk.size)
+				{
+					_offset = aligned + bytes;
+					return chunk.memory + aligned;
+				}
+
+				// the rest of a full chunk is given up, it is reclaimed with the next Rewind
+				if (++_chunkIndex < _chunks.size())
+				{
+					_offset = 0;
+					continue;
+				}
+			}
+
+			AddChunk(std::max({ ImportArena::chunkSize, _mergedChunkSize, bytes + alignment }));
+			_mergedChunkSize = 0;
+			_chunkIndex = _chunks.size() - 1;
+			_offset = 0;
+		}
+	}
+
+	void Arena::do_deallocate(void*, size_t, size_t)
+	{
+	}
+
+	bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	void Arena::AddChunk(size_t size)
+	{
+		Chunk chunk;
+		chunk.memory = static_cast<std::byte*>(::operator new(size, std::align_val_t(chunkAlignment)));
+		chunk.size = size;
+		_chunks.push_back(chunk);
+		ImportArena::statistics.heapAllocations++;
+	}
+
+	void Arena::FreeChunks()
+	{
+		for (const Chunk& chunk : _chunks)
+			::operator delete(chunk.memory, std::align_val_t(chunkAlignment));
+		_chunks.clear();
+	}
+
+	void* CountingResource::do_allocate(size_t bytes, size_t alignment)
+	{
+		// the arena counts its own chunks
+		ImportArena::statistics.allocations++;
+		ImportArena::statistics.bytes += bytes;
+		if (_upstream == std::pmr::new_delete_resource())
+			ImportArena::statistics.heapAllocations++;
+
+		return _upstream->allocate(bytes, alignment);
+	}
+
+	void CountingResource::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+	{
+		_upstream->deallocate(pointer, bytes, alignment);
+	}
+
+	bool CountingResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+	{
+		return this == &other;
+	}
+
+	Scope::Scope(ImportReport::Recorder* recorder)
+	{
+		// the upstream is picked once per outermost scope, a change of enabled during an import cannot split it
+		if (ImportArena::scopeDepth++ > 0)
+			return;
+
+		ImportArena::countingResource._upstream = ImportArena::enabled ? static_cast<std::pmr::memory_resource*>(&GetThreadArena()) : std::pmr::new_delete_resource();
+
+		_recorder = recorder;
+		_start = ImportArena::statistics;
+		if (_recorder)
+			_startTime = std::chrono::high_resolution_clock::now();
+	}
+
+	Scope::~Scope()
+	{
+		if (--ImportArena::scopeDepth > 0)
+			return;
+
+		if (_recorder)
+			_recorder->AddScratchAllocations(ImportArena::statistics.allocations - _start.allocations, ImportArena::statistics.heapAllocations - _start.heapAllocations,
+				std::chrono::high_resolution_clock::now() - _startTime);
+
+		if (ImportArena::countingResource._upstream != std::pmr::new_delete_resource())
+			GetThreadArena().Rewind();
+		ImportArena::countingResource._upstream = std::pmr::new_delete_resource();
+	}
+
+	std::pmr::memory_resource* GetResource()
+	{
+		return ImportArena::scopeDepth > 0 ? static_cast<std::pmr::memory_resource*>(&ImportArena::countingResource) : std::pmr::new_delete_resource();
+	}
+
+	void* MESHOPTIMIZER_ALLOC_CALLCONV AllocateForMeshopt(size_t size)
+	{
+		// meshoptimizer only needs the alignment of operator new
+		std::pmr::memory_resource* resource = GetResource();
+		auto* header = static_cast<AllocationHeader*>(resource->allocate(sizeof(AllocationHeader) + size, alignof(AllocationHeader)));
+		header->resource = resource;
+		header->size = size;
+		return header + 1;
+	}
+
+	void MESHOPTIMIZER_ALLOC_CALLCONV DeallocateForMeshopt(void* pointer)
+	{
+		// arena blocks wait for the Rewind, meshoptimizer frees before it returns so they never outlive the scope
+		auto* header = static_cast<AllocationHeader*>(pointer) - 1;
+		header->resource->deallocate(header, sizeof(AllocationHeader) + header->size, alignof(AllocationHeader));
+	}
+
+	void InstallMeshoptAllocator()
+	{
+		meshopt_setAllocator(AllocateForMeshopt, DeallocateForMeshopt);
+	}
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "pch.h"
+
+#include <memory_resource>
+
+#include "ImportReport.h"
+
+// per thread arenas for import temporaries: MeshProcessing scratch buffers and the internal allocations of meshoptimizer.
+// A Scope makes the arena of its thread current, once the outermost one closes the arena is rewound but keeps its memory,
+// so after the first primitives the import no longer competes for the general heap across loader threads. Results that
+// outlive the scope (vertices, indices, meshlets of a primitive) stay on the heap
+namespace ImportArena
+{
+	// of one thread, only ever increasing
+	struct Statistics
+	{
+		uint64_t allocations = 0; // scratch allocations made inside scopes, arena or not
+		uint64_t heapAllocations = 0; // of those (or of the arena chunks behind them) served by the heap
+		uint64_t bytes = 0;
+	};
+
+	// monotonic: deallocation is a no-op, memory comes back with Rewind
+	class Arena : public std::pmr::memory_resource
+	{
+	public:
+		Arena() = default;
+		~Arena();
+
+		Arena(const Arena&) = delete;
+		Arena& operator=(const Arena&) = delete;
+
+		// several chunks are replaced by one of their total size with the next allocation, so the next asset of the same
+		// size fits without growing. Above maxRetainedBytes the memory goes back to the heap
+		void Rewind();
+
+	private:
+		struct Chunk
+		{
+			std::byte* memory = nullptr;
+			size_t size = 0;
+		};
+
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void*, size_t, size_t) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+		void AddChunk(size_t size);
+		void FreeChunks();
+
+		std::vector<Chunk> _chunks;
+		size_t _chunkIndex = 0;
+		size_t _offset = 0;
+		size_t _mergedChunkSize = 0;
+	};
+
+	// counts everything a scope allocates, in front of the arena or (with enabled off) the heap, so both can be compared
+	class CountingResource : public std::pmr::memory_resource
+	{
+	public:
+		std::pmr::memory_resource* _upstream = std::pmr::new_delete_resource();
+
+	private:
+		void* do_allocate(size_t bytes, size_t alignment) override;
+		void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+		bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+	};
+
+	// opened around the import work of one primitive, nests (inner scopes count toward the outermost one). With a
+	// recorder the allocations and the wall time of the scope are added to its report, run once with enabled off for
+	// the heap baseline
+	class Scope
+	{
+	public:
+		explicit Scope(ImportReport::Recorder* recorder = nullptr);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		ImportReport::Recorder* _recorder = nullptr;
+		Statistics _start;
+		std::chrono::high_resolution_clock::time_point _startTime;
+	};
+
+	// the counting resource of the calling thread inside a Scope, the plain heap outside of one
+	std::pmr::memory_resource* GetResource();
+
+	// routes meshoptimizer's temporary allocations through GetResource, call once before any import
+	void InstallMeshoptAllocator();
+
+	extern bool enabled;
+	extern size_t chunkSize;
+	extern size_t maxRetainedBytes;
+}
@@ -0,0 +1,191 @@
+#include "ImportReport.h"
+
+#if defined(_WIN32)
+#include <psapi.h>
+#endif
+
+namespace ImportReport
+{
+	void Recorder::Add(STAGE stage, std::chrono::high_resolution_clock::duration duration, uint64_t bytes)
+	{
+		_nanoseconds[stage] += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+		_bytes[stage] += bytes;
+		_counts[stage]++;
+	}
+
+	void Recorder::AddCopiedBytes(uint64_t bytes)
+	{
+		_copiedBytes += bytes;
+	}
+
+	void Recorder::AddStagingBytes(int64_t bytes)
+	{
+		int64_t current = _stagingBytes += bytes;
+		int64_t peak = _peakStagingBytes;
+		while (current > peak && !_peakStagingBytes.compare_exchange_weak(peak, current))
+		{
+		}
+	}
+
+	void Recorder::AddScratchAllocations(uint64_t allocations, uint64_t heapAllocations, std::chrono::high_resolution_clock::duration duration)
+	{
+		_scratchAllocations += allocations;
+		_scratchHeapAllocations += heapAllocations;
+		_scratchNanoseconds += static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+	}
+
+	AssetReport Recorder::GetReport(bool succeeded) const
+	{
+		AssetReport report;
+		report.name = _name;
+		report.source = _source;
+		report.succeeded = succeeded;
+		report.loadMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - _startTime).count();
+
+		for (uint32_t stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			report.stages[stage].milliseconds = static_cast<double>(_nanoseconds[stage]) / 1e6;
+			report.stages[stage].bytes = _bytes[stage];
+			report.stages[stage].count = _counts[stage];
+		}
+
+		report.copiedBytes = _copiedBytes;
+		report.peakWorkingSetBytes = GetPeakWorkingSet();
+		report.peakStagingBytes = static_cast<uint64_t>(std::max<int64_t>(_peakStagingBytes, 0));
+		report.scratchAllocations = _scratchAllocations;
+		report.scratchHeapAllocations = _scratchHeapAllocations;
+		report.scratchMs = static_cast<double>(_scratchNanoseconds) / 1e6;
+
+		return report;
+	}
+
+	ScopedStage::ScopedStage(Recorder* recorder, STAGE stage)
+		: _recorder(recorder), _stage(stage)
+	{
+		if (_recorder)
+			_startTime = std::chrono::high_resolution_clock::now();
+	}
+
+	ScopedStage::~ScopedStage()
+	{
+		Stop();
+	}
+
+	void ScopedStage::Stop()
+	{
+		if (_recorder)
+			_recorder->Add(_stage, std::chrono::high_resolution_clock::now() - _startTime, _bytes);
+		_recorder = nullptr;
+	}
+
+	const char* GetStageName(STAGE stage)
+	{
+		switch (stage)
+		{
+		case STAGE_FILEMAP: return "fileMap";
+		case STAGE_JSONPARSE: return "jsonParse";
+		case STAGE_BUFFERDECODE: return "bufferDecode";
+		case STAGE_ACCESSORS: return "accessorExtraction";
+		case STAGE_WELD: return "vertexWelding";
+		case STAGE_TANGENTS: return "tangentGeneration";
+		case STAGE_MESHPROCESSING: return "meshProcessing";
+		case STAGE_IMAGEDECODE: return "imageDecode";
+		case STAGE_MIPS: return "mipGeneration";
+		case STAGE_COMPRESSION: return "blockCompression";
+		case STAGE_UPLOADRECORDING: return "uploadRecording";
+		default: return "unknown";
+		}
+	}
+
+	uint64_t GetPeakWorkingSet()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters = {};
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+			return counters.PeakWorkingSetSize;
+#endif
+		return 0;
+	}
+
+	void Print(const AssetReport& report)
+	{
+		PRINT("Import report: ", report.name, " (", report.source, ") | ", report.loadMs, "ms", report.succeeded ? "" : " | FAILED");
+
+		// stages that never ran (e.g. everything before the upload for a cache hit) are left out
+		for (uint32_t stage = 0; stage < STAGE_COUNT; ++stage)
+		{
+			const StageRecord& record = report.stages[stage];
+			if (record.count > 0)
+				PRINT("  ", GetStageName(static_cast<STAGE>(stage)), ": ", record.milliseconds, "ms | ", record.bytes / 1024, "KB | ", record.count, "x");
+		}
+
+		PRINT("  copied: ", report.copiedBytes / 1024, "KB | staging: ", report.peakStagingBytes / 1024, "KB peak, ", report.retainedStagingBytes / 1024, "KB retained | peak working set: ", report.peakWorkingSetBytes / (1024 * 1024), "MB");
+		PRINT("  scratch: ", report.scratchAllocations, " allocations | ", report.scratchHeapAllocations, " from the heap | ", report.scratchMs, "ms in scope");
+
+		for (const StreamingStage& streamingStage : report.streamingStages)
+			PRINT("  ", streamingStage.stage, " visible after ", streamingStage.visibleMs, "ms | ", streamingStage.uploadBytes / 1024, "KB uploaded");
+	}
+
+	bool WriteJson(std::span<const AssetReport> reports, const std::filesystem::path& path)
+	{
+		auto quoted = [](const std::string& text)
+		{
+			std::string result = "\"";
+			for (char character : text)
+			{
+				if (character == '"' || character == '\\')
+					result += '\\';
+				if (static_cast<unsigned char>(character) >= 0x20)
+					result += character;
+			}
+			return result + "\"";
+		};
+
+		std::ofstream file(path, std::ios::trunc);
+		if (!file)
+		{
+			PRINT("Failed to write import report ", path.string());
+			return false;
+		}
+
+		file << "{\n\t\"assets\": [";
+		for (size_t reportIndex = 0; reportIndex < reports.size(); ++reportIndex)
+		{
+			const AssetReport& report = reports[reportIndex];
+
+			file << (reportIndex == 0 ? "\n" : ",\n") << "\t\t{\n";
+			file << "\t\t\t\"name\": " << quoted(report.name) << ",\n";
+			file << "\t\t\t\"source\": " << quoted(report.source) << ",\n";
+			file << "\t\t\t\"succeeded\": " << (report.succeeded ? "true" : "false") << ",\n";
+			file << "\t\t\t\"loadMs\": " << report.loadMs << ",\n";
+			file << "\t\t\t\"copiedBytes\": " << report.copiedBytes << ",\n";
+			file << "\t\t\t\"peakWorkingSetBytes\": " << report.peakWorkingSetBytes << ",\n";
+			file << "\t\t\t\"peakStagingBytes\": " << report.peakStagingBytes << ",\n";
+			file << "\t\t\t\"retainedStagingBytes\": " << report.retainedStagingBytes << ",\n";
+			file << "\t\t\t\"scratchAllocations\": " << report.scratchAllocations << ",\n";
+			file << "\t\t\t\"scratchHeapAllocations\": " << report.scratchHeapAllocations << ",\n";
+			file << "\t\t\t\"scratchMs\": " << report.scratchMs << ",\n";
+
+			file << "\t\t\t\"stages\": {";
+			for (uint32_t stage = 0; stage < STAGE_COUNT; ++stage)
+			{
+				const StageRecord& record = report.stages[stage];
+				file << (stage == 0 ? "\n" : ",\n") << "\t\t\t\t\"" << GetStageName(static_cast<STAGE>(stage)) << "\": { \"ms\": " << record.milliseconds
+					<< ", \"bytes\": " << record.bytes << ", \"count\": " << record.count << " }";
+			}
+			file << "\n\t\t\t},\n";
+
+			file << "\t\t\t\"streamingStages\": [";
+			for (size_t stageIndex = 0; stageIndex < report.streamingStages.size(); ++stageIndex)
+			{
+				const StreamingStage& streamingStage = report.streamingStages[stageIndex];
+				file << (stageIndex == 0 ? "\n" : ",\n") << "\t\t\t\t{ \"stage\": " << quoted(streamingStage.stage) << ", \"visibleMs\": " << streamingStage.visibleMs
+					<< ", \"uploadBytes\": " << streamingStage.uploadBytes << " }";
+			}
+			file << (report.streamingStages.empty() ? "]\n" : "\n\t\t\t]\n") << "\t\t}";
+		}
+		file << (reports.empty() ? "]\n}\n" : "\n\t]\n}\n");
+
+		return static_cast<bool>(file);
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "pch.h"
+
+#include <atomic>
+
+// per asset timings and byte counts of the load stages. GLTFLoader fills a Recorder while the asset loads (from any
+// worker), ModelManager and the cooker turn it into an AssetReport that is read in code or written as JSON
+namespace ImportReport
+{
+	enum STAGE : uint32_t
+	{
+		STAGE_FILEMAP = 0,
+		STAGE_JSONPARSE = 1, // includes external buffers and images
+		STAGE_BUFFERDECODE = 2, // EXT_meshopt_compression
+		STAGE_ACCESSORS = 3,
+		STAGE_WELD = 4,
+		STAGE_TANGENTS = 5,
+		STAGE_MESHPROCESSING = 6, // optimization, lods and meshlets
+		STAGE_IMAGEDECODE = 7, // includes KTX2 transcoding and ORM packing
+		STAGE_MIPS = 8,
+		STAGE_COMPRESSION = 9,
+		STAGE_UPLOADRECORDING = 10,
+		STAGE_COUNT = 11
+	};
+
+	// stages on the worker pool sum the time of every worker, together they can exceed the wall time of the load
+	struct StageRecord
+	{
+		double milliseconds = 0.0;
+		uint64_t bytes = 0; // produced by the stage, read for the file map
+		uint32_t count = 0; // primitives, images, ... the stage ran for
+	};
+
+	// time from the start of the load until a streaming stage was first drawn
+	struct StreamingStage
+	{
+		std::string stage;
+		double visibleMs = 0.0;
+		uint64_t uploadBytes = 0;
+	};
+
+	struct AssetReport
+	{
+		std::string name;
+		std::string source; // "import", "cache" or "package"
+		bool succeeded = false;
+		double loadMs = 0.0; // wall time of the load job, until its last stage was submitted
+		StageRecord stages[STAGE_COUNT];
+		uint64_t copiedBytes = 0; // vertex, index and pixel data copied between CPU buffers, writes into upload heaps included
+		uint64_t peakWorkingSetBytes = 0; // of the whole process when the report was taken, 0 where it cannot be queried
+		// CPU side copies of this load (extracted geometry, decoded images, texture upload heaps): the most it held at once,
+		// and what its model still holds once every stage is published. Compare runs with GLTFLoader::releaseStagingCopies on and off
+		uint64_t peakStagingBytes = 0;
+		uint64_t retainedStagingBytes = 0; // set by ModelManager
+		uint64_t scratchAllocations = 0; // import temporaries allocated inside ImportArena scopes
+		uint64_t scratchHeapAllocations = 0; // heap allocations behind them: arena chunks, or all of them with the arena off
+		double scratchMs = 0.0; // wall time of those scopes summed over workers, compare runs with ImportArena::enabled on and off
+		std::vector<StreamingStage> streamingStages; // filled by ModelManager
+	};
+
+	class Recorder
+	{
+	public:
+		void Add(STAGE stage, std::chrono::high_resolution_clock::duration duration, uint64_t bytes = 0);
+		void AddCopiedBytes(uint64_t bytes);
+		// negative once a copy is released
+		void AddStagingBytes(int64_t bytes);
+		void AddScratchAllocations(uint64_t allocations, uint64_t heapAllocations, std::chrono::high_resolution_clock::duration duration);
+		AssetReport GetReport(bool succeeded) const;
+
+		std::string _name;
+		std::string _source;
+		std::chrono::high_resolution_clock::time_point _startTime = std::chrono::high_resolution_clock::now();
+
+	private:
+		std::atomic<uint64_t> _nanoseconds[STAGE_COUNT];
+		std::atomic<uint64_t> _bytes[STAGE_COUNT];
+		std::atomic<uint32_t> _counts[STAGE_COUNT];
+		std::atomic<uint64_t> _copiedBytes = 0;
+		std::atomic<uint64_t> _scratchAllocations = 0;
+		std::atomic<uint64_t> _scratchHeapAllocations = 0;
+		std::atomic<uint64_t> _scratchNanoseconds = 0;
+		std::atomic<int64_t> _stagingBytes = 0;
+		std::atomic<int64_t> _peakStagingBytes = 0;
+	};
+
+	// adds the time of its scope to the recorder, without one nothing is recorded
+	class ScopedStage
+	{
+	public:
+		ScopedStage(Recorder* recorder, STAGE stage);
+		~ScopedStage();
+
+		// records now instead of at the end of the scope
+		void Stop();
+
+		uint64_t _bytes = 0; // set before the scope ends
+
+	private:
+		Recorder* _recorder = nullptr;
+		STAGE _stage;
+		std::chrono::high_resolution_clock::time_point _startTime;
+	};
+
+	const char* GetStageName(STAGE stage);
+	uint64_t GetPeakWorkingSet();
+	void Print(const AssetReport& report);
+	bool WriteJson(std::span<const AssetReport> reports, const std::filesystem::path& path);
+}
@@ -0,0 +1,164 @@
+#include "JobSystem.h"
+
+namespace JobSystem
+{
+	std::vector<std::thread> workers;
+	std::deque<std::function<void()>> jobQueue;
+	std::mutex queueMutex;
+	std::condition_variable queueCondition;
+	bool stopping = false;
+
+	void WorkerLoop()
+	{
+#if defined(_WIN32)
+		// WIC decoding (images stb_image cannot read) happens on workers -> every worker needs COM
+		ThrowIfFailed(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+#endif
+
+		while (true)
+		{
+			std::function<void()> job;
+			{
+				std::unique_lock<std::mutex> lock(JobSystem::queueMutex);
+				JobSystem::queueCondition.wait(lock, [] { return JobSystem::stopping || !JobSystem::jobQueue.empty(); });
+
+				if (JobSystem::stopping && JobSystem::jobQueue.empty())
+					break;
+
+				job = std::move(JobSystem::jobQueue.front());
+				JobSystem::jobQueue.pop_front();
+			}
+
+			// a throwing job would take the worker and with it the process down, jobs report their own failures
+			try
+			{
+				job();
+			}
+			catch (const std::exception& exception)
+			{
+				PRINT("JobSystem: job failed: ", exception.what());
+			}
+			catch (...)
+			{
+				PRINT("JobSystem: job failed with an unknown exception");
+			}
+		}
+
+#if defined(_WIN32)
+		CoUninitialize();
+#endif
+	}
+
+	void InitializeJobSystem(uint32_t numWorkers)
+	{
+		if (!JobSystem::workers.empty())
+			return;
+
+		// leave one core for the calling thread. hardware_concurrency may return 0 (unknown), which must not wrap around
+		if (numWorkers == 0)
+			numWorkers = std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+		JobSystem::stopping = false;
+		JobSystem::workers.reserve(numWorkers);
+		for (uint32_t i = 0; i < numWorkers; ++i)
+			JobSystem::workers.emplace_back(WorkerLoop);
+	}
+
+	void Shutdown()
+	{
+		{
+			std::lock_guard<std::mutex> lock(JobSystem::queueMutex);
+			JobSystem::stopping = true;
+		}
+		JobSystem::queueCondition.notify_all();
+
+		for (std::thread& worker : JobSystem::workers)
+			worker.join();
+
+		JobSystem::workers.clear();
+	}
+
+	void Submit(std::function<void()> job)
+	{
+		if (JobSystem::workers.empty())
+			InitializeJobSystem();
+
+		{
+			std::lock_guard<std::mutex> lock(JobSystem::queueMutex);
+			JobSystem::jobQueue.push_back(std::move(job));
+		}
+		JobSystem::queueCondition.notify_one();
+	}
+
+	void ParallelFor(size_t count, const std::function<void(size_t)>& func)
+	{
+		if (count == 0)
+			return;
+
+		if (count == 1)
+		{
+			func(0);
+			return;
+		}
+
+		if (JobSystem::workers.empty())
+			InitializeJobSystem();
+
+		// shared so helpers that get scheduled after we returned still find valid (exhausted) state
+		struct ParallelForState
+		{
+			std::function<void(size_t)> func;
+			size_t count = 0;
+			std::atomic<size_t> nextIndex = 0;
+			std::atomic<size_t> completed = 0;
+			std::mutex mutex;
+			std::condition_variable done;
+			std::exception_ptr exception;
+		};
+
+		std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+		state->func = func;
+		state->count = count;
+
+		auto work = [state]()
+		{
+			size_t index;
+			while ((index = state->nextIndex.fetch_add(1)) < state->count)
+			{
+				try
+				{
+					state->func(index);
+				}
+				catch (...)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					if (!state->exception)
+						state->exception = std::current_exception();
+				}
+
+				if (state->completed.fetch_add(1) + 1 == state->count)
+				{
+					std::lock_guard<std::mutex> lock(state->mutex);
+					state->done.notify_all();
+				}
+			}
+		};
+
+		size_t helperCount = std::min(JobSystem::workers.size(), count - 1);
+		for (size_t i = 0; i < helperCount; ++i)
+			Submit(work);
+
+		work();
+
+		std::unique_lock<std::mutex> lock(state->mutex);
+		state->done.wait(lock, [&] { return state->completed.load() == state->count; });
+
+		if (state->exception)
+			std::rethrow_exception(state->exception);
+	}
+
+	uint32_t GetWorkerCount()
+	{
+		return static_cast<uint32_t>(JobSystem::workers.size());
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "pch.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <deque>
+#include <atomic>
+
+namespace JobSystem
+{
+	void InitializeJobSystem(uint32_t numWorkers = 0);
+	void Shutdown();
+
+	// exceptions escaping a job are logged and dropped, jobs that others wait on have to signal their failure themselves
+	void Submit(std::function<void()> job);
+
+	// runs func(0..count-1) on the worker pool, the calling thread helps out and returns once every index is done
+	void ParallelFor(size_t count, const std::function<void(size_t)>& func);
+
+	uint32_t GetWorkerCount();
+
+	extern std::vector<std::thread> workers;
+	extern std::deque<std::function<void()>> jobQueue;
+	extern std::mutex queueMutex;
+	extern std::condition_variable queueCondition;
+	extern bool stopping;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "pch.h"
+
+// read-only memory mapping of a whole file, closed on destruction
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	bool Open(const std::filesystem::path& path);
+	void Close();
+
+	bool IsOpen() const { return _data != nullptr; }
+	const uint8_t* GetData() const { return _data; }
+	uint64_t GetSize() const { return _size; }
+	std::span<const uint8_t> GetBytes() const { return { _data, static_cast<size_t>(_size) }; }
+
+private:
+	HANDLE _file = INVALID_HANDLE_VALUE;
+	HANDLE _mapping = nullptr;
+	const uint8_t* _data = nullptr;
+	uint64_t _size = 0;
+};
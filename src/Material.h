@@ -14,9 +14,8 @@ public:
 	std::string _name = "";
 	int32_t _baseColorTextureIndex = NOTOK;
 	int32_t _normalTextureIndex = NOTOK;
-	int32_t _metallicRoughnessTextureIndex = NOTOK;
+	int32_t _ormTextureIndex = NOTOK;
 	int32_t _emissiveTextureIndex = NOTOK;
-	int32_t _occlusionTextureIndex = NOTOK;
 
 	struct PBRFactors
 	{
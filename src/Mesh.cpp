@@ -3,5 +3,5 @@
 Mesh::Mesh(int32_t meshId, std::vector<Primitive> primitives)
 {
 	_id = meshId;
-	_primitives = primitives;
+	_primitives = std::move(primitives);
 }
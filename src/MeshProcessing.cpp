@@ -0,0 +1,884 @@
+#include "MeshProcessing.h"
+
+#include "JobSystem.h"
+#include "ImportArena.h"
+
+#include <random>
+
+namespace MeshProcessing
+{
+	bool weldVertices = true;
+	float weldPositionEpsilon = 0.0f;
+	float weldAttributeEpsilon = 0.0f;
+	bool optimizeMeshes = true;
+	uint32_t cacheSize = 16;
+	float overdrawThreshold = 1.05f;
+	bool buildMeshlets = true;
+	uint32_t maxMeshletVertices = 64;
+	uint32_t maxMeshletTriangles = 124;
+	float meshletConeWeight = 0.25f;
+	bool generateLods = true;
+	uint32_t maxLodCount = 5;
+	float lodReduction = 0.5f;
+	float lodTargetError = 0.02f;
+	uint32_t lodMinTriangles = 64;
+	float lodNormalWeight = 0.5f;
+	float lodUVWeight = 1.0f;
+	float lodPixelError = 1.0f;
+
+	void VertexCacheStatistics::Add(const VertexCacheStatistics& other)
+	{
+		triangleCount += other.triangleCount;
+		vertexCount += other.vertexCount;
+		verticesTransformed += other.verticesTransformed;
+		bytesFetched += other.bytesFetched;
+		vertexBytes += other.vertexBytes;
+	}
+
+	double VertexCacheStatistics::GetACMR() const
+	{
+		return triangleCount ? static_cast<double>(verticesTransformed) / static_cast<double>(triangleCount) : 0.0;
+	}
+
+	double VertexCacheStatistics::GetATVR() const
+	{
+		return vertexCount ? static_cast<double>(verticesTransformed) / static_cast<double>(vertexCount) : 0.0;
+	}
+
+	double VertexCacheStatistics::GetOverfetch() const
+	{
+		return vertexBytes ? static_cast<double>(bytesFetched) / static_cast<double>(vertexBytes) : 0.0;
+	}
+
+	void WeldStatistics::Add(const WeldStatistics& other)
+	{
+		verticesBefore += other.verticesBefore;
+		verticesAfter += other.verticesAfter;
+		unindexedPrimitives += other.unindexedPrimitives;
+	}
+
+	void OptimizationStatistics::Add(const OptimizationStatistics& other)
+	{
+		weld.Add(other.weld);
+		before.Add(other.before);
+		after.Add(other.after);
+	}
+
+	void OptimizationStatistics::Print(const std::string& name) const
+	{
+		if (weld.verticesBefore > 0)
+			PRINT("Vertex welding: ", name, " | vertices: ", weld.verticesBefore, " -> ", weld.verticesAfter, " | unindexed primitives: ", weld.unindexedPrimitives);
+
+		if (after.triangleCount == 0)
+			return;
+
+		PRINT("Mesh optimization: ", name, " | triangles: ", after.triangleCount, " | vertices: ", before.vertexCount, " -> ", after.vertexCount);
+		PRINT("  ACMR:      ", before.GetACMR(), " -> ", after.GetACMR());
+		PRINT("  ATVR:      ", before.GetATVR(), " -> ", after.GetATVR());
+		PRINT("  overfetch: ", before.GetOverfetch(), " -> ", after.GetOverfetch());
+	}
+
+	VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount)
+	{
+		VertexCacheStatistics statistics;
+		statistics.triangleCount = indices.size() / 3;
+		statistics.vertexCount = vertexCount;
+		statistics.vertexBytes = vertexCount * sizeof(Vertex);
+
+		if (indices.empty() || vertexCount == 0)
+			return statistics;
+
+		// plain FIFO model, no warp/primitive group limits
+		meshopt_VertexCacheStatistics cache = meshopt_analyzeVertexCache(indices.data(), indices.size(), vertexCount, MeshProcessing::cacheSize, 0, 0);
+		meshopt_VertexFetchStatistics fetch = meshopt_analyzeVertexFetch(indices.data(), indices.size(), vertexCount, sizeof(Vertex));
+
+		statistics.verticesTransformed = cache.vertices_transformed;
+		statistics.bytesFetched = fetch.bytes_fetched;
+
+		return statistics;
+	}
+
+	// four triangles side by side, one per lane
+	struct Vector3x4
+	{
+		XMVECTOR x;
+		XMVECTOR y;
+		XMVECTOR z;
+	};
+
+	Vector3x4 Subtract(const Vector3x4& a, const Vector3x4& b)
+	{
+		return { XMVectorSubtract(a.x, b.x), XMVectorSubtract(a.y, b.y), XMVectorSubtract(a.z, b.z) };
+	}
+
+	Vector3x4 Scale(const Vector3x4& a, XMVECTOR scale)
+	{
+		return { XMVectorMultiply(a.x, scale), XMVectorMultiply(a.y, scale), XMVectorMultiply(a.z, scale) };
+	}
+
+	XMVECTOR Dot(const Vector3x4& a, const Vector3x4& b)
+	{
+		return XMVectorMultiplyAdd(a.x, b.x, XMVectorMultiplyAdd(a.y, b.y, XMVectorMultiply(a.z, b.z)));
+	}
+
+	// zero length lanes stay zero
+	Vector3x4 NormalizeOrZero(const Vector3x4& a)
+	{
+		XMVECTOR lengthSq = Dot(a, a);
+		XMVECTOR valid = XMVectorGreater(lengthSq, XMVectorReplicate(1e-20f));
+		XMVECTOR inverseLength = XMVectorSelect(XMVectorZero(), XMVectorReciprocalSqrt(lengthSq), valid);
+		return Scale(a, inverseLength);
+	}
+
+	// removes the part along the (unit) normal
+	Vector3x4 ProjectOntoPlane(const Vector3x4& a, const Vector3x4& normal)
+	{
+		return Subtract(a, Scale(normal, Dot(normal, a)));
+	}
+
+	// the previous generator: per triangle, unweighted, one vertex = one tangent. Only kept as benchmark baseline
+	void GenerateTangentsReference(std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices)
+	{
+		std::vector<XMFLOAT3> accumulatedTan(vertices.size(), XMFLOAT3(0, 0, 0));
+		std::vector<XMFLOAT3> accumulatedBitan(vertices.size(), XMFLOAT3(0, 0, 0));
+
+		for (size_t i = 0; i < indices.size(); i += 3) {
+			uint32_t i0 = indices[i + 0];
+			uint32_t i1 = indices[i + 1];
+			uint32_t i2 = indices[i + 2];
+
+			XMVECTOR v0 = XMLoadFloat3(&vertices[i0].position);
+			XMVECTOR edge1 = XMVectorSubtract(XMLoadFloat3(&vertices[i1].position), v0);
+			XMVECTOR edge2 = XMVectorSubtract(XMLoadFloat3(&vertices[i2].position), v0);
+
+			float du1 = vertices[i1].uv.x - vertices[i0].uv.x;
+			float dv1 = vertices[i1].uv.y - vertices[i0].uv.y;
+			float du2 = vertices[i2].uv.x - vertices[i0].uv.x;
+			float dv2 = vertices[i2].uv.y - vertices[i0].uv.y;
+
+			float det = du1 * dv2 - du2 * dv1;
+			if (fabs(det) < 1e-6f) det = 1.0f;
+			float invDet = 1.0f / det;
+
+			XMFLOAT3 t, b;
+			XMStoreFloat3(&t, XMVectorScale(XMVectorSubtract(XMVectorScale(edge1, dv2), XMVectorScale(edge2, dv1)), invDet));
+			XMStoreFloat3(&b, XMVectorScale(XMVectorSubtract(XMVectorScale(edge2, du1), XMVectorScale(edge1, du2)), invDet));
+
+			for (uint32_t index : { i0, i1, i2 })
+			{
+				accumulatedTan[index].x += t.x; accumulatedTan[index].y += t.y; accumulatedTan[index].z += t.z;
+				accumulatedBitan[index].x += b.x; accumulatedBitan[index].y += b.y; accumulatedBitan[index].z += b.z;
+			}
+		}
+
+		for (size_t i = 0; i < vertices.size(); ++i) {
+			XMVECTOR N = XMVector3Normalize(XMLoadFloat3(&vertices[i].normal));
+			XMVECTOR T = XMLoadFloat3(&accumulatedTan[i]);
+			XMVECTOR B = XMLoadFloat3(&accumulatedBitan[i]);
+
+			T = XMVector3Normalize(XMVectorSubtract(T, XMVectorScale(N, XMVectorGetX(XMVector3Dot(N, T)))));
+			float handedness = (XMVectorGetX(XMVector3Dot(XMVector3Cross(N, T), B)) < 0.0f) ? -1.0f : 1.0f;
+
+			XMFLOAT3 tangent;
+			XMStoreFloat3(&tangent, T);
+			vertices[i].tangent = XMFLOAT4(tangent.x, tangent.y, tangent.z, handedness);
+		}
+	}
+
+	void WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, WeldStatistics* statistics)
+	{
+		if (statistics)
+			statistics->verticesBefore += vertices.size();
+
+		if (indices.empty() || vertices.empty())
+		{
+			if (statistics)
+				statistics->verticesAfter += vertices.size();
+			return;
+		}
+
+		// the hash sees the quantized copy, the first vertex of every cell keeps its exact values
+		const Vertex* keys = vertices.data();
+		std::pmr::vector<Vertex> quantized(ImportArena::GetResource());
+		if (MeshProcessing::weldPositionEpsilon > 0.0f || MeshProcessing::weldAttributeEpsilon > 0.0f)
+		{
+			// + 0.0f turns -0 into 0, the hash compares bytes
+			auto quantize = [](float& value, float epsilon)
+			{
+				if (epsilon > 0.0f)
+					value = std::round(value / epsilon) * epsilon + 0.0f;
+			};
+
+			quantized.assign(vertices.begin(), vertices.end());
+			for (Vertex& vertex : quantized)
+			{
+				quantize(vertex.position.x, MeshProcessing::weldPositionEpsilon);
+				quantize(vertex.position.y, MeshProcessing::weldPositionEpsilon);
+				quantize(vertex.position.z, MeshProcessing::weldPositionEpsilon);
+				quantize(vertex.normal.x, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.normal.y, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.normal.z, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.uv.x, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.uv.y, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.tangent.x, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.tangent.y, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.tangent.z, MeshProcessing::weldAttributeEpsilon);
+				quantize(vertex.tangent.w, MeshProcessing::weldAttributeEpsilon);
+			}
+			keys = quantized.data();
+		}
+
+		std::pmr::vector<uint32_t> remap(vertices.size(), ImportArena::GetResource());
+		size_t vertexCount = meshopt_generateVertexRemap(remap.data(), indices.data(), indices.size(), keys, vertices.size(), sizeof(Vertex));
+
+		// the first vertex of every tuple is the representative, later duplicates must not overwrite it
+		std::vector<Vertex> welded(vertexCount);
+		std::pmr::vector<bool> written(vertexCount, false, ImportArena::GetResource());
+		for (size_t vertexIndex = 0; vertexIndex < vertices.size(); ++vertexIndex)
+		{
+			uint32_t target = remap[vertexIndex];
+			if (target != UINT32_MAX && !written[target])
+			{
+				welded[target] = vertices[vertexIndex];
+				written[target] = true;
+			}
+		}
+
+		meshopt_remapIndexBuffer(indices.data(), indices.data(), indices.size(), remap.data());
+		vertices = std::move(welded);
+
+		if (statistics)
+			statistics->verticesAfter += vertices.size();
+	}
+
+	void GenerateTangents(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+	{
+		if (indices.empty() || vertices.empty())
+			return;
+
+		size_t triangleCount = indices.size() / 3;
+
+		// like MikkTSpace, vertices are identified by value: identical position/normal/uv accumulate into one tangent
+		std::pmr::vector<uint32_t> welded(vertices.size(), ImportArena::GetResource());
+		meshopt_Stream stream = { &vertices[0].position.x, offsetof(Vertex, tangent), sizeof(Vertex) };
+		size_t weldedCount = meshopt_generateVertexRemapMulti(welded.data(), nullptr, vertices.size(), vertices.size(), &stream, 1);
+
+		// angle weighted tangent per corner, orientation per triangle: 1 preserving, -1 mirrored uvs, 0 degenerate (joins any group)
+		std::pmr::vector<XMFLOAT3> cornerTangents(triangleCount * 3, ImportArena::GetResource());
+		std::pmr::vector<int8_t> orientations(triangleCount, ImportArena::GetResource());
+
+		for (size_t first = 0; first < triangleCount; first += 4)
+		{
+			size_t laneCount = std::min<size_t>(4, triangleCount - first);
+
+			alignas(16) float position[3][3][4];
+			alignas(16) float normal[3][3][4];
+			alignas(16) float uv[3][2][4];
+
+			// the tail repeats its last triangle, the extra lanes are never written back
+			for (size_t lane = 0; lane < 4; ++lane)
+			{
+				size_t triangle = first + std::min(lane, laneCount - 1);
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const Vertex& vertex = vertices[indices[triangle * 3 + corner]];
+					position[corner][0][lane] = vertex.position.x;
+					position[corner][1][lane] = vertex.position.y;
+					position[corner][2][lane] = vertex.position.z;
+					normal[corner][0][lane] = vertex.normal.x;
+					normal[corner][1][lane] = vertex.normal.y;
+					normal[corner][2][lane] = vertex.normal.z;
+					uv[corner][0][lane] = vertex.uv.x;
+					uv[corner][1][lane] = vertex.uv.y;
+				}
+			}
+
+			Vector3x4 p[3];
+			Vector3x4 n[3];
+			XMVECTOR u[3];
+			XMVECTOR v[3];
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				p[corner] = { XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(position[corner][0])), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(position[corner][1])), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(position[corner][2])) };
+				n[corner] = NormalizeOrZero({ XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(normal[corner][0])), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(normal[corner][1])), XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(normal[corner][2])) });
+				u[corner] = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(uv[corner][0]));
+				v[corner] = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(uv[corner][1]));
+			}
+
+			// face tangent from the uv derivatives, normalized and flipped with the sign of the uv area (MikkTSpace vOs)
+			Vector3x4 d21 = Subtract(p[1], p[0]);
+			Vector3x4 d31 = Subtract(p[2], p[0]);
+			XMVECTOR t21x = XMVectorSubtract(u[1], u[0]);
+			XMVECTOR t21y = XMVectorSubtract(v[1], v[0]);
+			XMVECTOR t31x = XMVectorSubtract(u[2], u[0]);
+			XMVECTOR t31y = XMVectorSubtract(v[2], v[0]);
+
+			XMVECTOR signedUVArea = XMVectorSubtract(XMVectorMultiply(t21x, t31y), XMVectorMultiply(t21y, t31x));
+			Vector3x4 faceTangent = NormalizeOrZero(Subtract(Scale(d21, t31y), Scale(d31, t21y)));
+			faceTangent = Scale(faceTangent, XMVectorSelect(XMVectorReplicate(-1.0f), XMVectorReplicate(1.0f), XMVectorGreater(signedUVArea, XMVectorZero())));
+
+			Vector3x4 faceNormal = { XMVectorSubtract(XMVectorMultiply(d21.y, d31.z), XMVectorMultiply(d21.z, d31.y)),
+				XMVectorSubtract(XMVectorMultiply(d21.z, d31.x), XMVectorMultiply(d21.x, d31.z)),
+				XMVectorSubtract(XMVectorMultiply(d21.x, d31.y), XMVectorMultiply(d21.y, d31.x)) };
+
+			XMVECTOR degenerate = XMVectorOrInt(XMVectorLessOrEqual(XMVectorAbs(signedUVArea), XMVectorReplicate(1e-20f)), XMVectorLessOrEqual(Dot(faceNormal, faceNormal), XMVectorReplicate(1e-30f)));
+
+			alignas(16) float tangent[3][3][4];
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				// corner angle measured in the tangent plane of the vertex normal
+				Vector3x4 edge1 = NormalizeOrZero(ProjectOntoPlane(Subtract(p[(corner + 1) % 3], p[corner]), n[corner]));
+				Vector3x4 edge2 = NormalizeOrZero(ProjectOntoPlane(Subtract(p[(corner + 2) % 3], p[corner]), n[corner]));
+				XMVECTOR angle = XMVectorACos(XMVectorClamp(Dot(edge1, edge2), XMVectorReplicate(-1.0f), XMVectorReplicate(1.0f)));
+				angle = XMVectorSelect(angle, XMVectorZero(), degenerate);
+
+				Vector3x4 cornerTangent = Scale(NormalizeOrZero(ProjectOntoPlane(faceTangent, n[corner])), angle);
+				XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(tangent[corner][0]), cornerTangent.x);
+				XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(tangent[corner][1]), cornerTangent.y);
+				XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(tangent[corner][2]), cornerTangent.z);
+			}
+
+			alignas(16) float area[4];
+			alignas(16) uint32_t degenerateMask[4];
+			XMStoreFloat4A(reinterpret_cast<XMFLOAT4A*>(area), signedUVArea);
+			XMStoreUInt4(reinterpret_cast<XMUINT4*>(degenerateMask), degenerate);
+
+			for (size_t lane = 0; lane < laneCount; ++lane)
+			{
+				size_t triangle = first + lane;
+				orientations[triangle] = degenerateMask[lane] ? 0 : (area[lane] > 0.0f ? 1 : -1);
+				for (size_t corner = 0; corner < 3; ++corner)
+					cornerTangents[triangle * 3 + corner] = { tangent[corner][0][lane], tangent[corner][1][lane], tangent[corner][2][lane] };
+			}
+		}
+
+		// a vertex used by preserving and mirrored triangles gets a copy for the mirrored side
+		enum : uint8_t { USED_PRESERVING = 1, USED_MIRRORED = 2 };
+		size_t sourceVertexCount = vertices.size();
+		std::pmr::vector<uint8_t> usage(sourceVertexCount, 0, ImportArena::GetResource());
+		for (size_t i = 0; i < indices.size(); ++i)
+			if (orientations[i / 3] != 0)
+				usage[indices[i]] |= orientations[i / 3] > 0 ? USED_PRESERVING : USED_MIRRORED;
+
+		std::pmr::vector<uint32_t> mirroredCopy(sourceVertexCount, UINT32_MAX, ImportArena::GetResource());
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			uint32_t index = indices[i];
+			if (orientations[i / 3] >= 0 || usage[index] != (USED_PRESERVING | USED_MIRRORED))
+				continue;
+
+			if (mirroredCopy[index] == UINT32_MAX)
+			{
+				mirroredCopy[index] = static_cast<uint32_t>(vertices.size());
+				vertices.push_back(vertices[index]);
+				welded.push_back(welded[index]);
+				usage.push_back(USED_MIRRORED);
+			}
+			indices[i] = mirroredCopy[index];
+		}
+
+		// one accumulator per (welded vertex, orientation)
+		auto groupOf = [&](uint32_t index, bool mirrored) { return static_cast<size_t>(welded[index]) * 2 + (mirrored ? 1 : 0); };
+
+		std::pmr::vector<XMFLOAT3> accumulated(weldedCount * 2, XMFLOAT3(0, 0, 0), ImportArena::GetResource());
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			int8_t orientation = orientations[i / 3];
+			if (orientation == 0)
+				continue;
+
+			XMFLOAT3& sum = accumulated[groupOf(indices[i], orientation < 0)];
+			sum.x += cornerTangents[i].x;
+			sum.y += cornerTangents[i].y;
+			sum.z += cornerTangents[i].z;
+		}
+
+		for (size_t i = 0; i < vertices.size(); ++i)
+		{
+			Vertex& vertex = vertices[i];
+			bool mirrored = usage[i] == USED_MIRRORED;
+
+			XMVECTOR N = XMVector3Normalize(XMLoadFloat3(&vertex.normal));
+			XMVECTOR T = XMLoadFloat3(&accumulated[groupOf(static_cast<uint32_t>(i), mirrored)]);
+			T = XMVectorSubtract(T, XMVectorMultiply(N, XMVector3Dot(N, T)));
+
+			// only degenerate triangles around this vertex, any direction in the tangent plane will do
+			if (XMVectorGetX(XMVector3LengthSq(T)) < 1e-20f)
+			{
+				XMVECTOR axis = std::abs(vertex.normal.x) < 0.9f ? XMVectorSet(1, 0, 0, 0) : XMVectorSet(0, 1, 0, 0);
+				T = XMVector3Cross(XMVector3Cross(N, axis), N);
+			}
+
+			XMFLOAT3 tangent;
+			XMStoreFloat3(&tangent, XMVector3Normalize(T));
+			vertex.tangent = XMFLOAT4(tangent.x, tangent.y, tangent.z, mirrored ? -1.0f : 1.0f);
+		}
+	}
+
+	void BenchmarkTangentGeneration(uint32_t triangleCount)
+	{
+		// wavy grid, the right half has mirrored uvs so seams get exercised as well
+		uint32_t columns = std::max(2u, static_cast<uint32_t>(std::sqrt(static_cast<double>(triangleCount))));
+		uint32_t rows = std::max(1u, triangleCount / (2 * columns));
+
+		std::vector<Vertex> sourceVertices;
+		sourceVertices.reserve(static_cast<size_t>(rows + 1) * (columns + 1));
+		for (uint32_t y = 0; y <= rows; ++y)
+		{
+			for (uint32_t x = 0; x <= columns; ++x)
+			{
+				float fx = static_cast<float>(x) / columns;
+				float fy = static_cast<float>(y) / rows;
+				float height = 0.05f * std::sin(fx * 40.0f) * std::cos(fy * 40.0f);
+
+				XMFLOAT3 normal;
+				XMStoreFloat3(&normal, XMVector3Normalize(XMVectorSet(-2.0f * std::cos(fx * 40.0f) * std::cos(fy * 40.0f), 1.0f, 2.0f * std::sin(fx * 40.0f) * std::sin(fy * 40.0f), 0.0f)));
+
+				Vertex& vertex = sourceVertices.emplace_back();
+				vertex.position = { fx, height, fy };
+				vertex.normal = normal;
+				vertex.uv = { fx < 0.5f ? fx : 1.0f - fx, fy };
+				vertex.tangent = { 0, 0, 0, 0 };
+			}
+		}
+
+		std::vector<uint32_t> sourceIndices;
+		sourceIndices.reserve(static_cast<size_t>(rows) * columns * 6);
+		for (uint32_t y = 0; y < rows; ++y)
+		{
+			for (uint32_t x = 0; x < columns; ++x)
+			{
+				uint32_t i0 = y * (columns + 1) + x;
+				uint32_t i1 = i0 + 1;
+				uint32_t i2 = i0 + columns + 1;
+				uint32_t i3 = i2 + 1;
+				sourceIndices.insert(sourceIndices.end(), { i0, i2, i1, i1, i2, i3 });
+			}
+		}
+
+		std::vector<Vertex> referenceVertices = sourceVertices;
+		Utils::Timer::StartTimer();
+		GenerateTangentsReference(referenceVertices, sourceIndices);
+		double referenceMs = Utils::Timer::GetElapsedMilliseconds();
+
+		std::vector<Vertex> vertices = sourceVertices;
+		std::vector<uint32_t> indices = sourceIndices;
+		Utils::Timer::StartTimer();
+		GenerateTangents(vertices, indices);
+		double simdMs = Utils::Timer::GetElapsedMilliseconds();
+
+		// the same mesh as independent primitives (row bands), the way the loader runs them
+		uint32_t bandCount = JobSystem::GetWorkerCount() * 4;
+		uint32_t rowsPerBand = (rows + bandCount - 1) / bandCount;
+		std::vector<std::vector<Vertex>> bandVertices(bandCount);
+		std::vector<std::vector<uint32_t>> bandIndices(bandCount);
+		for (uint32_t band = 0; band < bandCount; ++band)
+		{
+			uint32_t firstRow = std::min(rows, band * rowsPerBand);
+			uint32_t lastRow = std::min(rows, firstRow + rowsPerBand);
+			bandVertices[band].assign(sourceVertices.begin() + static_cast<size_t>(firstRow) * (columns + 1), sourceVertices.begin() + static_cast<size_t>(lastRow + 1) * (columns + 1));
+			for (size_t i = static_cast<size_t>(firstRow) * columns * 6; i < static_cast<size_t>(lastRow) * columns * 6; ++i)
+				bandIndices[band].push_back(sourceIndices[i] - firstRow * (columns + 1));
+		}
+
+		// scratch buffers on the thread arenas and, as baseline, on the heap. Fresh band copies per run, the generator splits vertices
+		auto runBands = [&](bool useArena, ImportReport::AssetReport& report)
+		{
+			std::vector<std::vector<Vertex>> runVertices = bandVertices;
+			std::vector<std::vector<uint32_t>> runIndices = bandIndices;
+
+			bool arenaEnabled = ImportArena::enabled;
+			ImportArena::enabled = useArena;
+
+			ImportReport::Recorder recorder;
+			Utils::Timer::StartTimer();
+			JobSystem::ParallelFor(bandCount, [&](size_t band)
+			{
+				ImportArena::Scope arenaScope(&recorder);
+				GenerateTangents(runVertices[band], runIndices[band]);
+			});
+			double elapsedMs = Utils::Timer::GetElapsedMilliseconds();
+
+			ImportArena::enabled = arenaEnabled;
+			report = recorder.GetReport(true);
+			return elapsedMs;
+		};
+
+		ImportReport::AssetReport heapReport;
+		ImportReport::AssetReport arenaReport;
+		double heapMs = runBands(false, heapReport);
+		double parallelMs = runBands(true, arenaReport);
+
+		// mean angle between the old and new tangents on the vertices that were not split
+		double angleSum = 0.0;
+		for (size_t i = 0; i < sourceVertices.size(); ++i)
+		{
+			XMVECTOR a = XMLoadFloat4(&referenceVertices[i].tangent);
+			XMVECTOR b = XMLoadFloat4(&vertices[i].tangent);
+			angleSum += std::acos(std::clamp(XMVectorGetX(XMVector3Dot(a, b)), -1.0f, 1.0f));
+		}
+
+		PRINT("Tangent generation benchmark: ", indices.size() / 3, " triangles | ", sourceVertices.size(), " vertices (", vertices.size() - sourceVertices.size(), " split at mirrored seams)");
+		PRINT("  reference:         ", referenceMs, "ms");
+		PRINT("  simd:              ", simdMs, "ms (", referenceMs / std::max(simdMs, 0.001), "x)");
+		PRINT("  simd, ", bandCount, " primitives on ", JobSystem::GetWorkerCount(), " workers: ", parallelMs, "ms (", referenceMs / std::max(parallelMs, 0.001), "x)");
+		PRINT("    arena scratch: ", arenaReport.scratchAllocations, " allocations | ", arenaReport.scratchHeapAllocations, " from the heap | ", arenaReport.scratchMs, "ms in scope");
+		PRINT("    heap scratch:  ", heapReport.scratchAllocations, " allocations | ", heapReport.scratchHeapAllocations, " from the heap | ", heapReport.scratchMs, "ms in scope (", heapMs, "ms wall)");
+		PRINT("  mean deviation from reference: ", XMConvertToDegrees(static_cast<float>(angleSum / sourceVertices.size())), " degrees");
+	}
+
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, OptimizationStatistics* statistics)
+	{
+		if (indices.empty() || vertices.empty())
+			return;
+
+		if (statistics)
+			statistics->before = AnalyzeVertexCache(indices, vertices.size());
+
+		std::pmr::vector<uint32_t> reordered(indices.size(), ImportArena::GetResource());
+
+		meshopt_optimizeVertexCache(reordered.data(), indices.data(), indices.size(), vertices.size());
+
+		// only reorders clusters of the cache optimized order, so the cache gains mostly survive
+		meshopt_optimizeOverdraw(indices.data(), reordered.data(), reordered.size(), &vertices[0].position.x, vertices.size(), sizeof(Vertex), MeshProcessing::overdrawThreshold);
+
+		// vertices in first use order, unreferenced vertices are dropped
+		std::vector<Vertex> remapped(vertices.size());
+		size_t vertexCount = meshopt_optimizeVertexFetch(remapped.data(), indices.data(), indices.size(), vertices.data(), vertices.size(), sizeof(Vertex));
+		remapped.resize(vertexCount);
+		vertices = std::move(remapped);
+
+		if (statistics)
+			statistics->after = AnalyzeVertexCache(indices, vertices.size());
+	}
+
+	void GenerateLods(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<LodLevel>& lods)
+	{
+		if (indices.empty() || vertices.empty() || lods.empty())
+			return;
+
+		// meshopt reports errors relative to the mesh extent
+		float errorScale = meshopt_simplifyScale(&vertices[0].position.x, vertices.size(), sizeof(Vertex));
+
+		// normal xyz followed by uv xy in Vertex
+		static_assert(offsetof(Vertex, uv) == offsetof(Vertex, normal) + sizeof(XMFLOAT3));
+		const float attributeWeights[5] = {
+			MeshProcessing::lodNormalWeight, MeshProcessing::lodNormalWeight, MeshProcessing::lodNormalWeight,
+			MeshProcessing::lodUVWeight, MeshProcessing::lodUVWeight
+		};
+
+		std::pmr::vector<uint32_t> source(indices.begin() + lods.back().indexOffset, indices.begin() + lods.back().indexOffset + lods.back().indexCount, ImportArena::GetResource());
+		std::pmr::vector<uint32_t> simplified(source.size(), ImportArena::GetResource());
+		std::pmr::vector<uint32_t> reordered(source.size(), ImportArena::GetResource());
+
+		while (lods.size() < MeshProcessing::maxLodCount)
+		{
+			size_t targetIndexCount = static_cast<size_t>(static_cast<float>(source.size() / 3) * MeshProcessing::lodReduction) * 3;
+			if (targetIndexCount < static_cast<size_t>(MeshProcessing::lodMinTriangles) * 3)
+				break;
+
+			float levelError = 0.0f;
+			size_t indexCount = meshopt_simplifyWithAttributes(simplified.data(), source.data(), source.size(),
+				&vertices[0].position.x, vertices.size(), sizeof(Vertex),
+				&vertices[0].normal.x, sizeof(Vertex), attributeWeights, 5, nullptr,
+				targetIndexCount, MeshProcessing::lodTargetError, meshopt_SimplifyLockBorder, &levelError);
+
+			// the error bound (or the locked borders) stopped the collapse early, a level this close to the previous one is not worth its memory
+			if (indexCount == 0 || indexCount > source.size() * 9 / 10)
+				break;
+
+			meshopt_optimizeVertexCache(reordered.data(), simplified.data(), indexCount, vertices.size());
+
+			LodLevel& lod = lods.emplace_back();
+			lod.indexOffset = static_cast<uint32_t>(indices.size());
+			lod.indexCount = static_cast<uint32_t>(indexCount);
+			lod.error = lods[lods.size() - 2].error + levelError * errorScale;
+
+			indices.insert(indices.end(), reordered.begin(), reordered.begin() + indexCount);
+			source.assign(reordered.begin(), reordered.begin() + indexCount);
+		}
+	}
+
+	void BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<LodLevel>& lods, std::vector<Meshlet>& meshlets)
+	{
+		meshlets.clear();
+		if (indices.empty() || vertices.empty())
+			return;
+
+		std::vector<uint32_t> clusteredIndices;
+		clusteredIndices.reserve(indices.size());
+
+		for (LodLevel& lod : lods)
+		{
+			std::span<const uint32_t> lodIndices(indices.data() + lod.indexOffset, lod.indexCount);
+
+			size_t maxMeshlets = meshopt_buildMeshletsBound(lodIndices.size(), MeshProcessing::maxMeshletVertices, MeshProcessing::maxMeshletTriangles);
+			std::pmr::vector<meshopt_Meshlet> clusters(maxMeshlets, ImportArena::GetResource());
+			std::pmr::vector<uint32_t> clusterVertices(maxMeshlets * MeshProcessing::maxMeshletVertices, ImportArena::GetResource());
+			std::pmr::vector<uint8_t> clusterTriangles(maxMeshlets * MeshProcessing::maxMeshletTriangles * 3, ImportArena::GetResource());
+
+			size_t clusterCount = meshopt_buildMeshlets(clusters.data(), clusterVertices.data(), clusterTriangles.data(),
+				lodIndices.data(), lodIndices.size(), &vertices[0].position.x, vertices.size(), sizeof(Vertex),
+				MeshProcessing::maxMeshletVertices, MeshProcessing::maxMeshletTriangles, MeshProcessing::meshletConeWeight);
+
+			lod.indexOffset = static_cast<uint32_t>(clusteredIndices.size());
+			lod.meshletOffset = static_cast<uint32_t>(meshlets.size());
+			lod.meshletCount = static_cast<uint32_t>(clusterCount);
+
+			// cluster local triangles back to primitive indices, one contiguous range per cluster
+			for (size_t i = 0; i < clusterCount; ++i)
+			{
+				const meshopt_Meshlet& cluster = clusters[i];
+				Meshlet& meshlet = meshlets.emplace_back();
+
+				meshlet.indexOffset = static_cast<uint32_t>(clusteredIndices.size());
+				meshlet.indexCount = cluster.triangle_count * 3;
+
+				for (uint32_t j = 0; j < cluster.triangle_count * 3; ++j)
+					clusteredIndices.push_back(clusterVertices[cluster.vertex_offset + clusterTriangles[cluster.triangle_offset + j]]);
+
+				meshopt_Bounds bounds = meshopt_computeMeshletBounds(&clusterVertices[cluster.vertex_offset], &clusterTriangles[cluster.triangle_offset],
+					cluster.triangle_count, &vertices[0].position.x, vertices.size(), sizeof(Vertex));
+
+				meshlet.center = { bounds.center[0], bounds.center[1], bounds.center[2] };
+				meshlet.radius = bounds.radius;
+				meshlet.coneApex = { bounds.cone_apex[0], bounds.cone_apex[1], bounds.cone_apex[2] };
+				meshlet.coneAxis = { bounds.cone_axis[0], bounds.cone_axis[1], bounds.cone_axis[2] };
+				meshlet.coneCutoff = bounds.cone_cutoff;
+			}
+
+			lod.indexCount = static_cast<uint32_t>(clusteredIndices.size()) - lod.indexOffset;
+		}
+
+		indices = std::move(clusteredIndices);
+	}
+
+	MeshletValidation ValidateMeshlets(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const Meshlet> meshlets, std::span<const XMFLOAT3> viewpoints)
+	{
+		constexpr float epsilon = 1e-3f;
+
+		MeshletValidation validation;
+		for (const Meshlet& meshlet : meshlets)
+		{
+			XMVECTOR center = XMLoadFloat3(&meshlet.center);
+			XMVECTOR axis = XMLoadFloat3(&meshlet.coneAxis);
+			XMVECTOR apex = XMLoadFloat3(&meshlet.coneApex);
+
+			// cutoff = sin of the cone half angle around the axis -> every normal satisfies dot(n, axis) >= cos(half angle)
+			float minDot = std::sqrt(std::max(0.0f, 1.0f - meshlet.coneCutoff * meshlet.coneCutoff));
+			bool insideSphere = true;
+			bool insideCone = true;
+
+			for (uint32_t i = meshlet.indexOffset; i + 2 < meshlet.indexOffset + meshlet.indexCount; i += 3)
+			{
+				XMVECTOR p0 = XMLoadFloat3(&vertices[indices[i + 0]].position);
+				XMVECTOR p1 = XMLoadFloat3(&vertices[indices[i + 1]].position);
+				XMVECTOR p2 = XMLoadFloat3(&vertices[indices[i + 2]].position);
+
+				for (XMVECTOR p : { p0, p1, p2 })
+					insideSphere &= XMVectorGetX(XMVector3Length(p - center)) <= meshlet.radius * (1.0f + epsilon) + epsilon;
+
+				// degenerate cones (cutoff 1) never cull, nothing to check
+				XMVECTOR normal = XMVector3Cross(p1 - p0, p2 - p0);
+				if (meshlet.coneCutoff >= 1.0f || XMVectorGetX(XMVector3LengthSq(normal)) <= 1e-12f)
+					continue;
+
+				normal = XMVector3Normalize(normal);
+				insideCone &= XMVectorGetX(XMVector3Dot(normal, axis)) >= minDot - epsilon;
+
+				// a viewpoint the cone culls from has to see the back of every triangle
+				for (const XMFLOAT3& viewpoint : viewpoints)
+				{
+					XMVECTOR position = XMLoadFloat3(&viewpoint);
+					bool culled = XMVectorGetX(XMVector3Dot(XMVector3Normalize(apex - position), axis)) >= meshlet.coneCutoff;
+					if (culled && XMVectorGetX(XMVector3Dot(normal, position - p0)) > epsilon)
+						insideCone = false;
+				}
+			}
+
+			validation.sphereViolations += insideSphere ? 0 : 1;
+			validation.coneViolations += insideCone ? 0 : 1;
+		}
+
+		return validation;
+	}
+
+	void TestMeshletBounds()
+	{
+		struct TestMesh
+		{
+			const char* name;
+			std::vector<Vertex> vertices;
+			std::vector<uint32_t> indices;
+		};
+
+		// mt19937 is bit exact on every platform and the floats are derived from its integers, every run sees the same meshes
+		std::mt19937 random(1234);
+		auto unit = [&random]() { return static_cast<float>(random() >> 8) * (1.0f / 16777216.0f); };
+
+		std::vector<TestMesh> meshes;
+
+		TestMesh& grid = meshes.emplace_back(TestMesh{ "wavy grid" });
+		const uint32_t gridSize = 96;
+		for (uint32_t y = 0; y <= gridSize; ++y)
+			for (uint32_t x = 0; x <= gridSize; ++x)
+			{
+				float fx = static_cast<float>(x) / gridSize;
+				float fy = static_cast<float>(y) / gridSize;
+				grid.vertices.push_back({ { fx, 0.1f * std::sin(fx * 20.0f) * std::cos(fy * 20.0f), fy }, { 0, 1, 0 }, { fx, fy }, { 1, 0, 0, 1 } });
+			}
+		for (uint32_t y = 0; y < gridSize; ++y)
+			for (uint32_t x = 0; x < gridSize; ++x)
+			{
+				uint32_t i0 = y * (gridSize + 1) + x;
+				uint32_t i2 = i0 + gridSize + 1;
+				grid.indices.insert(grid.indices.end(), { i0, i2, i0 + 1, i0 + 1, i2, i2 + 1 });
+			}
+
+		TestMesh& sphere = meshes.emplace_back(TestMesh{ "sphere" });
+		const uint32_t rings = 48;
+		const uint32_t segments = 96;
+		for (uint32_t ring = 0; ring <= rings; ++ring)
+			for (uint32_t segment = 0; segment <= segments; ++segment)
+			{
+				float theta = XM_PI * ring / rings;
+				float phi = XM_2PI * segment / segments;
+				XMFLOAT3 position = { std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi) };
+				sphere.vertices.push_back({ position, position, { static_cast<float>(segment) / segments, static_cast<float>(ring) / rings }, { 1, 0, 0, 1 } });
+			}
+		for (uint32_t ring = 0; ring < rings; ++ring)
+			for (uint32_t segment = 0; segment < segments; ++segment)
+			{
+				uint32_t i0 = ring * (segments + 1) + segment;
+				uint32_t i2 = i0 + segments + 1;
+				sphere.indices.insert(sphere.indices.end(), { i0, i0 + 1, i2, i0 + 1, i2 + 1, i2 });
+			}
+
+		// unrelated triangles that share vertices at random, wide cones and spheres that touch every corner
+		TestMesh& soup = meshes.emplace_back(TestMesh{ "random soup" });
+		for (uint32_t i = 0; i < 2048; ++i)
+			soup.vertices.push_back({ { unit() * 4.0f - 2.0f, unit() * 4.0f - 2.0f, unit() * 4.0f - 2.0f }, { 0, 1, 0 }, { unit(), unit() }, { 1, 0, 0, 1 } });
+		for (uint32_t i = 0; i < 3 * 6000; ++i)
+			soup.indices.push_back(static_cast<uint32_t>(random() % soup.vertices.size()));
+
+		// around and inside the meshes, near and far
+		std::vector<XMFLOAT3> viewpoints;
+		for (uint32_t i = 0; i < 64; ++i)
+		{
+			float distance = i < 32 ? 0.5f + unit() : 3.0f + unit() * 20.0f;
+			XMVECTOR direction = XMVector3Normalize(XMVectorSet(unit() - 0.5f, unit() - 0.5f, unit() - 0.5f, 0.0f));
+			XMFLOAT3 viewpoint;
+			XMStoreFloat3(&viewpoint, XMVectorScale(direction, distance));
+			viewpoints.push_back(viewpoint);
+		}
+
+		uint32_t failedMeshes = 0;
+		for (TestMesh& mesh : meshes)
+		{
+			std::vector<LodLevel> lods = { { 0, static_cast<uint32_t>(mesh.indices.size()) } };
+			std::vector<Meshlet> meshlets;
+			BuildMeshlets(mesh.vertices, mesh.indices, lods, meshlets);
+
+			MeshletValidation validation = ValidateMeshlets(mesh.vertices, mesh.indices, meshlets, viewpoints);
+			PRINT("Meshlet bounds test: ", mesh.name, " | ", meshlets.size(), " meshlets | ", validation.sphereViolations, " sphere and ", validation.coneViolations, " cone violations");
+
+			if (validation.sphereViolations > 0 || validation.coneViolations > 0)
+				failedMeshes++;
+		}
+
+		if (failedMeshes > 0)
+			ThrowException("Meshlet bounds test: non conservative bounds on " + std::to_string(failedMeshes) + " meshes");
+	}
+
+	CullingView MakeCullingView(const CullingCamera& camera, const XMFLOAT4X4& objectToWorld)
+	{
+		CullingView view;
+
+		// row vector convention (clip = p * VP), planes from the columns, inside is dot(plane, p) >= 0
+		const XMFLOAT4X4& m = camera.viewProjection;
+		XMFLOAT4 column[4];
+		for (int j = 0; j < 4; ++j)
+			column[j] = { m.m[0][j], m.m[1][j], m.m[2][j], m.m[3][j] };
+
+		XMVECTOR c0 = XMLoadFloat4(&column[0]);
+		XMVECTOR c1 = XMLoadFloat4(&column[1]);
+		XMVECTOR c2 = XMLoadFloat4(&column[2]);
+		XMVECTOR c3 = XMLoadFloat4(&column[3]);
+
+		XMVECTOR worldPlanes[6] = { c3 + c0, c3 - c0, c3 + c1, c3 - c1, c2, c3 - c2 };
+
+		// dot(plane, p * M) == dot(M * plane, p), so object space planes are M * plane
+		XMMATRIX world = XMLoadFloat4x4(&objectToWorld);
+		XMMATRIX worldTransposed = XMMatrixTranspose(world);
+		for (int i = 0; i < 6; ++i)
+		{
+			XMVECTOR plane = worldPlanes[i] / XMVector3Length(worldPlanes[i]);
+			XMStoreFloat4(&view.frustumPlanes[i], XMVector4Transform(plane, worldTransposed));
+		}
+
+		XMVECTOR determinant;
+		XMMATRIX worldToObject = XMMatrixInverse(&determinant, world);
+		XMStoreFloat3(&view.cameraPosition, XMVector3TransformCoord(XMLoadFloat3(&camera.position), worldToObject));
+
+		float scaleX = XMVectorGetX(XMVector3Length(world.r[0]));
+		float scaleY = XMVectorGetX(XMVector3Length(world.r[1]));
+		float scaleZ = XMVectorGetX(XMVector3Length(world.r[2]));
+		float maxScale = std::max({ scaleX, scaleY, scaleZ });
+		float minScale = std::min({ scaleX, scaleY, scaleZ });
+
+		view.radiusScale = maxScale;
+		// object space error over object space distance, the uniform part of the scale cancels out
+		view.projectionScale = camera.projectionScale;
+		view.coneCulling = XMVectorGetX(determinant) > 0.0f && maxScale - minScale <= maxScale * 0.01f;
+
+		return view;
+	}
+
+	bool IsMeshletVisible(const Meshlet& meshlet, const CullingView& view)
+	{
+		XMVECTOR center = XMVectorSetW(XMLoadFloat3(&meshlet.center), 1.0f);
+		float radius = meshlet.radius * view.radiusScale;
+
+		for (const XMFLOAT4& plane : view.frustumPlanes)
+			if (XMVectorGetX(XMVector4Dot(XMLoadFloat4(&plane), center)) < -radius)
+				return false;
+
+		if (view.coneCulling && meshlet.coneCutoff < 1.0f)
+		{
+			XMVECTOR toApex = XMVector3Normalize(XMLoadFloat3(&meshlet.coneApex) - XMLoadFloat3(&view.cameraPosition));
+			if (XMVectorGetX(XMVector3Dot(toApex, XMLoadFloat3(&meshlet.coneAxis))) >= meshlet.coneCutoff)
+				return false;
+		}
+
+		return true;
+	}
+
+	void CullMeshlets(std::span<const Meshlet> meshlets, const CullingView& view, std::vector<uint32_t>& visibleMeshlets)
+	{
+		visibleMeshlets.clear();
+		for (size_t i = 0; i < meshlets.size(); ++i)
+			if (IsMeshletVisible(meshlets[i], view))
+				visibleMeshlets.push_back(static_cast<uint32_t>(i));
+	}
+
+	uint32_t SelectLod(std::span<const LodLevel> lods, const XMFLOAT3& center, float radius, const CullingView& view, float maxPixelError)
+	{
+		if (lods.empty() || view.projectionScale <= 0.0f)
+			return 0;
+
+		float distance = XMVectorGetX(XMVector3Length(XMLoadFloat3(&center) - XMLoadFloat3(&view.cameraPosition))) - radius;
+		if (distance <= 0.0f)
+			return 0;
+
+		// errors grow with every level, stop at the first one that would be visible
+		uint32_t selected = 0;
+		for (uint32_t i = 1; i < lods.size(); ++i)
+		{
+			if (lods[i].error / distance * view.projectionScale > maxPixelError)
+				break;
+			selected = i;
+		}
+
+		return selected;
+	}
+}
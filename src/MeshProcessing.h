@@ -0,0 +1,156 @@
+#pragma once
+
+#include "pch.h"
+
+#include "meshoptimizer.h"
+
+// CPU side mesh passes that run on extracted primitives, before anything touches the GPU
+namespace MeshProcessing
+{
+	// summed over primitives so per-asset ratios are weighted by triangle/vertex count
+	struct VertexCacheStatistics
+	{
+		uint64_t triangleCount = 0;
+		uint64_t vertexCount = 0;
+		uint64_t verticesTransformed = 0;
+		uint64_t bytesFetched = 0;
+		uint64_t vertexBytes = 0;
+
+		void Add(const VertexCacheStatistics& other);
+
+		// average cache miss ratio: transformed vertices per triangle (0.5 is the ideal for a regular grid)
+		double GetACMR() const;
+		// average transform to vertex ratio: 1.0 means every vertex is transformed exactly once
+		double GetATVR() const;
+		// bytes fetched by the vertex stage relative to the size of the vertex buffer
+		double GetOverfetch() const;
+	};
+
+	struct WeldStatistics
+	{
+		uint64_t verticesBefore = 0;
+		uint64_t verticesAfter = 0;
+		uint32_t unindexedPrimitives = 0;
+
+		void Add(const WeldStatistics& other);
+	};
+
+	struct OptimizationStatistics
+	{
+		WeldStatistics weld;
+		VertexCacheStatistics before;
+		VertexCacheStatistics after;
+
+		void Add(const OptimizationStatistics& other);
+		void Print(const std::string& name) const;
+	};
+
+	// cluster of up to maxMeshletVertices/maxMeshletTriangles, its triangles are one contiguous index range of the primitive
+	struct Meshlet
+	{
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+
+		XMFLOAT3 center = { 0, 0, 0 };
+		float radius = 0.0f;
+
+		// backface cone: invisible from every position p with dot(normalize(coneApex - p), coneAxis) >= coneCutoff
+		XMFLOAT3 coneApex = { 0, 0, 0 };
+		float coneCutoff = 1.0f;
+		XMFLOAT3 coneAxis = { 0, 0, 1 };
+		uint32_t reserved = 0;
+	};
+
+	// one level of detail: a range of the shared index buffer (all levels use the same vertices) and its meshlets
+	struct LodLevel
+	{
+		uint32_t indexOffset = 0;
+		uint32_t indexCount = 0;
+		uint32_t meshletOffset = 0;
+		uint32_t meshletCount = 0;
+		float error = 0.0f; // object space distance the surface deviates from LOD 0, accumulated over all simplification steps
+	};
+
+	// world space input, turned into a CullingView per node
+	struct CullingCamera
+	{
+		XMFLOAT4X4 viewProjection = {};
+		XMFLOAT3 position = { 0, 0, 0 };
+		float projectionScale = 0.0f; // pixels covered by one unit at distance one, viewportHeight * proj._22 / 2
+	};
+
+	// everything in object space of the primitive so meshlet bounds are used as stored
+	struct CullingView
+	{
+		XMFLOAT4 frustumPlanes[6] = {};
+		XMFLOAT3 cameraPosition = { 0, 0, 0 };
+		float radiusScale = 1.0f; // object space plane distances are scaled by the transform, radii have to follow
+		float projectionScale = 0.0f; // 0 disables lod selection
+		bool coneCulling = true; // cones only stay valid under rotation, translation and uniform scale
+	};
+
+	VertexCacheStatistics AnalyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount);
+
+	// merges vertices whose full attribute tuple is identical and rewrites the indices, unreferenced vertices are dropped.
+	// With an epsilon the tuples are compared on a grid of that spacing (positions and the other attributes separately),
+	// values close to a cell border can still end up in different cells
+	void WeldVertices(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, WeldStatistics* statistics = nullptr);
+
+	// MikkTSpace compatible: corner tangents weighted by the corner angle, shared by all vertices with identical
+	// position/normal/uv and split where mirrored uvs meet (which appends vertices and rewrites indices).
+	// Four triangles per SIMD pass, no shared state so primitives can run in parallel
+	void GenerateTangents(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+	// synthetic mesh without tangents, compared against the previous per triangle implementation
+	void BenchmarkTangentGeneration(uint32_t triangleCount);
+
+	// vertex cache -> overdraw -> vertex fetch, in that order since each step keeps the locality of the previous one
+	void OptimizeMesh(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, OptimizationStatistics* statistics = nullptr);
+
+	// appends coarser levels to the indices, each simplified from the last level in lods (which needs at least LOD 0).
+	// uv and normal seams are kept since split vertices only collapse along their seam, open borders stay locked
+	// so neighbouring primitives do not crack apart
+	void GenerateLods(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<LodLevel>& lods);
+
+	// reorders the indices of every level so each meshlet is a contiguous range, run after OptimizeMesh/GenerateLods
+	void BuildMeshlets(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, std::vector<LodLevel>& lods, std::vector<Meshlet>& meshlets);
+
+	struct MeshletValidation
+	{
+		uint32_t sphereViolations = 0; // meshlets with a vertex outside their bounding sphere
+		uint32_t coneViolations = 0; // meshlets with a triangle normal outside their cone or culled from a viewpoint one of their triangles faces
+	};
+
+	// the cone is checked against the triangle normals and, for every viewpoint, against the culling test of IsMeshletVisible
+	MeshletValidation ValidateMeshlets(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const Meshlet> meshlets, std::span<const XMFLOAT3> viewpoints = {});
+
+	// builds meshlets on fixed synthetic meshes (wavy grid, sphere, random triangle soup) and throws if a sphere or cone
+	// is not conservative
+	void TestMeshletBounds();
+
+	CullingView MakeCullingView(const CullingCamera& camera, const XMFLOAT4X4& objectToWorld);
+	bool IsMeshletVisible(const Meshlet& meshlet, const CullingView& view);
+	void CullMeshlets(std::span<const Meshlet> meshlets, const CullingView& view, std::vector<uint32_t>& visibleMeshlets);
+
+	// coarsest level whose error, projected at the closest point of the bounding sphere, stays below maxPixelError
+	uint32_t SelectLod(std::span<const LodLevel> lods, const XMFLOAT3& center, float radius, const CullingView& view, float maxPixelError);
+
+	extern bool weldVertices;
+	extern float weldPositionEpsilon;
+	extern float weldAttributeEpsilon;
+	extern bool optimizeMeshes;
+	extern bool buildMeshlets;
+	extern uint32_t maxMeshletVertices;
+	extern uint32_t maxMeshletTriangles;
+	extern float meshletConeWeight;
+	extern bool generateLods;
+	extern uint32_t maxLodCount;
+	extern float lodReduction;
+	extern float lodTargetError;
+	extern uint32_t lodMinTriangles;
+	extern float lodNormalWeight;
+	extern float lodUVWeight;
+	extern float lodPixelError;
+	extern uint32_t cacheSize;
+	extern float overdrawThreshold;
+}
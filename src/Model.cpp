@@ -1,17 +1,17 @@
 #include "Model.h"
 
-Model::Model(int32_t id, std::string name, std::vector<Mesh> meshes, std::vector<Texture> textures, std::vector<Material> materials, std::vector<ModelNode> modelNodes)
+Model::Model(int32_t id, std::string name, std::vector<Mesh> meshes, std::vector<std::shared_ptr<Texture>> textures, std::vector<Material> materials, std::vector<ModelNode> modelNodes)
 {
 	_id = id;
-	_name = name;
-	_meshes = meshes;
+	_name = std::move(name);
+	_meshes = std::move(meshes);
 	_textures = std::move(textures);
-	_materials = materials;
-	_modelNodes = modelNodes;
+	_materials = std::move(materials);
+	_modelNodes = std::move(modelNodes);
 	XMStoreFloat4x4(&_globalMatrix, XMMatrixIdentity()) ;
 }
 
-void Model::DrawModel(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
+void Model::DrawModel(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, const MeshProcessing::CullingCamera* cullingCamera)
 {
 	ComputeGlobalTransforms();
 
@@ -24,37 +24,45 @@ void Model::DrawModel(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12Graphics
 
 		node.BindModelMatrixData(shaderPass, commandList);
 
-		std::vector<Primitive> transparentPrimitives;
+		MeshProcessing::CullingView cullingView;
+		if (cullingCamera)
+			cullingView = MeshProcessing::MakeCullingView(*cullingCamera, node._globalMatrix);
+
+		auto drawPrimitive = [&](Primitive& primitive)
+		{
+			cullingCamera ? primitive.DrawCulled(commandList, shaderPass._vertexStreamMask, cullingView) : primitive.BindPrimitiveData(commandList, shaderPass._vertexStreamMask);
+		};
+
+		std::vector<Primitive*> transparentPrimitives;
 
 		for (Primitive& primitive : mesh._primitives)
 		{
 			Material& material = _materials[primitive._materialIndex];
 			if (material._alphaMode == fastgltf::AlphaMode::Blend || material._alphaMode == fastgltf::AlphaMode::Mask)
 			{
-				transparentPrimitives.push_back(primitive);
+				transparentPrimitives.push_back(&primitive);
 				continue;
 			}
 
-			material._baseColorTextureIndex != NOTOK ? _textures[material._baseColorTextureIndex].BindTexture(shaderPass, commandList) : PRINT("baseColorTextureIndex NOTOK");
-			material._metallicRoughnessTextureIndex != NOTOK ? _textures[material._metallicRoughnessTextureIndex].BindTexture(shaderPass, commandList) : PRINT("metallicRoughnessTextureIndex NOTOK");
-			material._normalTextureIndex != NOTOK ? _textures[material._normalTextureIndex].BindTexture(shaderPass, commandList) : PRINT("normalTextureIndex NOTOK");
-			material._emissiveTextureIndex != NOTOK ? _textures[material._emissiveTextureIndex].BindTexture(shaderPass, commandList) : PRINT("emissiveTextureIndex NOTOK");
-			material._occlusionTextureIndex != NOTOK ? _textures[material._occlusionTextureIndex].BindTexture(shaderPass, commandList) : PRINT("occlusionTextureIndex NOTOK");
+			material._baseColorTextureIndex != NOTOK ? _textures[material._baseColorTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("baseColorTextureIndex NOTOK");
+			material._ormTextureIndex != NOTOK ? _textures[material._ormTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("ormTextureIndex NOTOK");
+			material._normalTextureIndex != NOTOK ? _textures[material._normalTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("normalTextureIndex NOTOK");
+			material._emissiveTextureIndex != NOTOK ? _textures[material._emissiveTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("emissiveTextureIndex NOTOK");
 			material.BindMaterialFactorsData(shaderPass, commandList);
-			primitive.BindPrimitiveData(commandList);
+			drawPrimitive(primitive);
 		}
 
-		for (Primitive& primitive : transparentPrimitives)
+		for (Primitive* transparentPrimitive : transparentPrimitives)
 		{
+			Primitive& primitive = *transparentPrimitive;
 			Material& material = _materials[primitive._materialIndex];
 
-			material._baseColorTextureIndex != NOTOK ? _textures[material._baseColorTextureIndex].BindTexture(shaderPass, commandList) : PRINT("baseColorTextureIndex NOTOK");
-			material._metallicRoughnessTextureIndex != NOTOK ? _textures[material._metallicRoughnessTextureIndex].BindTexture(shaderPass, commandList) : PRINT("metallicRoughnessTextureIndex NOTOK");
-			material._normalTextureIndex != NOTOK ? _textures[material._normalTextureIndex].BindTexture(shaderPass, commandList) : PRINT("normalTextureIndex NOTOK");
-			material._emissiveTextureIndex != NOTOK ? _textures[material._emissiveTextureIndex].BindTexture(shaderPass, commandList) : PRINT("emissiveTextureIndex NOTOK");
-			material._occlusionTextureIndex != NOTOK ? _textures[material._occlusionTextureIndex].BindTexture(shaderPass, commandList) : PRINT("occlusionTextureIndex NOTOK");
+			material._baseColorTextureIndex != NOTOK ? _textures[material._baseColorTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("baseColorTextureIndex NOTOK");
+			material._ormTextureIndex != NOTOK ? _textures[material._ormTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("ormTextureIndex NOTOK");
+			material._normalTextureIndex != NOTOK ? _textures[material._normalTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("normalTextureIndex NOTOK");
+			material._emissiveTextureIndex != NOTOK ? _textures[material._emissiveTextureIndex]->BindTexture(shaderPass, commandList) : PRINT("emissiveTextureIndex NOTOK");
 			material.BindMaterialFactorsData(shaderPass, commandList);
-			primitive.BindPrimitiveData(commandList);
+			drawPrimitive(primitive);
 		}
 	}
 }
@@ -130,6 +138,18 @@ int32_t Model::GetID()
 	return _id;
 }
 
+const std::vector<std::shared_ptr<Texture>>& Model::GetTextures() const
+{
+	return _textures;
+}
+
+void Model::TakeContent(Model& other)
+{
+	_meshes = std::move(other._meshes);
+	_textures = std::move(other._textures);
+	_materials = std::move(other._materials);
+}
+
 void Model::DrawGUI() {
 	std::string windowName = "Model: " + _name + " ID: " + std::to_string(_id);
 	ImGui::Begin(windowName.c_str());
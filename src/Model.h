@@ -16,13 +16,18 @@ class Model : public IGUIComponent
 {
 public:
 	Model() = default;
-	Model(int32_t id, std::string name, std::vector<Mesh> meshes, std::vector<Texture> textures, std::vector<Material> materials, std::vector<ModelNode> modelNodes);
+	Model(int32_t id, std::string name, std::vector<Mesh> meshes, std::vector<std::shared_ptr<Texture>> textures, std::vector<Material> materials, std::vector<ModelNode> modelNodes);
 
-	void DrawModel(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
+	// with a culling camera only the visible meshlets of every primitive are drawn
+	void DrawModel(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, const MeshProcessing::CullingCamera* cullingCamera = nullptr);
 	void DrawModelBoundingBox(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
 
 	void DrawGUI();
 	int32_t GetID();
+	const std::vector<std::shared_ptr<Texture>>& GetTextures() const;
+	// takes meshes, textures and materials of a later streaming stage of the same asset. Id, nodes, transform and the
+	// GUI registration stay, call between frames only: the replaced resources are released right away
+	void TakeContent(Model& other);
 
 private:
 	void ComputeGlobalTransforms();
@@ -31,7 +36,7 @@ private:
 	int32_t _id = NOTOK;
 	std::string _name;
 	std::vector<Mesh> _meshes;
-	std::vector<Texture> _textures;
+	std::vector<std::shared_ptr<Texture>> _textures;
 	std::vector<Material> _materials;
 	std::vector<ModelNode> _modelNodes;
 
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Texture.h"
+#include "Material.h"
+#include "MeshProcessing.h"
+
+// CPU side results of the import pipeline, no GPU objects in here so it can be produced on any thread
+// (and without a device at all) and cached/cooked to disk
+
+struct PrimitiveData
+{
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices; // all lod levels back to back, LOD 0 first
+	std::vector<MeshProcessing::LodLevel> lods;
+	std::vector<MeshProcessing::Meshlet> meshlets;
+	int32_t materialIndex = NOTOK;
+};
+
+// non-owning view of a primitive, either into PrimitiveData or into a mapped package
+struct PrimitiveView
+{
+	std::span<const Vertex> vertices;
+	std::span<const uint32_t> indices;
+	std::span<const MeshProcessing::LodLevel> lods;
+	std::span<const MeshProcessing::Meshlet> meshlets;
+	int32_t materialIndex = NOTOK;
+};
+
+struct MaterialData
+{
+	Material::PBRFactors pbrFactors;
+	fastgltf::AlphaMode alphaMode = fastgltf::AlphaMode::Opaque;
+	int32_t textureIndices[Texture::TEXTURETYPE_COUNT] = { NOTOK, NOTOK, NOTOK, NOTOK }; // indexed by Texture::TEXTURETYPE
+};
+
+struct NodeData
+{
+	std::string name;
+	int32_t meshIndex = NOTOK;
+	int32_t parentIndex = -1;
+	std::vector<int32_t> children;
+	XMFLOAT4X4 localMatrix = {};
+};
+
+struct TextureJob
+{
+	Texture::TEXTURETYPE textureType = Texture::TEXTURETYPE::TEXTURE_ALBEDO;
+	std::optional<size_t> imageIndex; // no image -> fallback texture
+	std::optional<size_t> fallbackImageIndex; // decoded when imageIndex (KTX2) fails
+	// ORM jobs whose channels come from separate images: imageIndex is the metallic/roughness image (the occlusion image
+	// when there is none), channels without a source are set to 1
+	bool packORM = false;
+	std::optional<size_t> occlusionImageIndex;
+	float alphaCutoff = 0.0f; // albedo of a MASK material: the mips keep the fraction of texels passing the cutoff
+	uint64_t contentHash = 0;
+	int32_t sourceJobIndex = NOTOK; // same image + type as an earlier job of this asset
+	ScratchImage scratchImage;
+	std::shared_ptr<Texture> texture; // set for cache hits
+};
+
+struct ModelData
+{
+	std::string name;
+	std::vector<std::vector<PrimitiveData>> meshes;
+	std::vector<MaterialData> materials;
+	std::vector<TextureJob> textures;
+	std::vector<NodeData> nodes;
+};
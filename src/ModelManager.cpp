@@ -1,29 +1,288 @@
 #include "ModelManager.h"
 
-void ModelManager::LoadModel(const std::filesystem::path& path)
+ModelManager::ModelHandle ModelManager::LoadModel(const std::filesystem::path& path)
 {
-	CommandContext uploadContext;
-	uploadContext.InitializeCommandContext(QUEUETYPE::QUEUE_UPLOAD);
+	std::shared_ptr<PendingLoad> load = AddPendingLoad(path);
 
-	std::shared_ptr<Model> model;
+	JobSystem::Submit([load]()
+	{
+		auto onStage = [&load](GLTFLoader::ModelStage&& stage)
+		{
+			std::lock_guard<std::mutex> lock(load->stageMutex);
+			load->stages.push_back(std::move(stage));
+		};
+
+		FinishLoad(*load, StreamLoad(*load, onStage));
+	});
+
+	return load->handle;
+}
+
+std::vector<ModelManager::ModelHandle> ModelManager::LoadModels(std::span<const std::filesystem::path> paths)
+{
+	std::vector<std::shared_ptr<PendingLoad>> loads;
+	std::vector<ModelHandle> handles;
+	for (const std::filesystem::path& path : paths)
+	{
+		loads.push_back(AddPendingLoad(path));
+		handles.push_back(loads.back()->handle);
+	}
+
+	if (loads.empty())
+		return handles;
+
+	JobSystem::Submit([loads]()
+	{
+		// the stages only reach their loads with the fence of the batch
+		std::vector<GLTFLoader::ModelStage> stages(loads.size());
+		std::vector<uint8_t> streamed(loads.size(), 0);
+
+		GLTFLoader::UploadBatch batch;
+		try
+		{
+			batch.uploadContext = std::make_shared<CommandContext>();
+			batch.uploadContext->InitializeCommandContext(QUEUETYPE::QUEUE_UPLOAD);
+
+			JobSystem::ParallelFor(loads.size(), [&](size_t loadIndex)
+			{
+				auto onStage = [&stages, loadIndex](GLTFLoader::ModelStage&& stage) { stages[loadIndex] = std::move(stage); };
+				streamed[loadIndex] = StreamLoad(*loads[loadIndex], onStage, &batch);
+			});
+
+			GLTFLoader::SubmitUploadBatch(batch, stages);
+		}
+		catch (const std::exception& exception)
+		{
+			// nothing of the batch reached the GPU: every load fails, the textures it recorded leave the cache
+			PRINT("Upload batch of ", loads.size(), " models failed: ", exception.what());
+			if (batch.uploadContext)
+				TextureCache::EvictPendingUploads(batch.uploadContext->GetRecordingId());
+			std::fill(streamed.begin(), streamed.end(), 0);
+		}
+
+		for (size_t loadIndex = 0; loadIndex < loads.size(); ++loadIndex)
+		{
+			PendingLoad& load = *loads[loadIndex];
+			if (streamed[loadIndex])
+			{
+				std::lock_guard<std::mutex> lock(load.stageMutex);
+				load.stages.push_back(std::move(stages[loadIndex]));
+			}
+
+			FinishLoad(load, streamed[loadIndex]);
+		}
+	});
+
+	return handles;
+}
+
+std::shared_ptr<ModelManager::PendingLoad> ModelManager::AddPendingLoad(const std::filesystem::path& path)
+{
+	ModelHandle handle = static_cast<ModelHandle>(_loadStates.size());
+	_loadStates.push_back(LOAD_PENDING);
+	_handleModels.push_back(nullptr);
+	_importReports.emplace_back();
+
+	std::shared_ptr<PendingLoad> load = std::make_shared<PendingLoad>();
+	load->handle = handle;
+	load->path = path;
+	load->startTime = std::chrono::high_resolution_clock::now();
+	_pendingLoads.push_back(load);
+
+	return load;
+}
 
-	bool constructedModel = GLTFLoader::ConstructModelFromFile(path, model, uploadContext.GetCommandList());
+bool ModelManager::StreamLoad(PendingLoad& load, const GLTFLoader::StageCallback& onStage, GLTFLoader::UploadBatch* batch)
+{
+	bool streamedModel = false;
+	try
+	{
+		streamedModel = Utils::HasExtension(load.path, ModelPackage::PACKAGE_EXTENSION)
+			? GLTFLoader::StreamModelFromPackage(load.path, onStage, &load.recorder, batch)
+			: GLTFLoader::StreamModelFromFile(load.path, onStage, &load.recorder, batch);
 
-	if (constructedModel)
+		if (!streamedModel)
+			PRINT("Loading ", load.path.string(), " failed");
+	}
+	catch (const std::exception& exception)
 	{
+		PRINT("Loading ", load.path.string(), " failed: ", exception.what());
+	}
+
+	return streamedModel;
+}
+
+void ModelManager::FinishLoad(PendingLoad& load, bool streamedModel)
+{
+	load.report = load.recorder.GetReport(streamedModel);
+	load.done = true;
+	load.done.notify_all();
+}
+
+void ModelManager::Update()
+{
+	std::erase_if(_pendingLoads, [this](const std::shared_ptr<PendingLoad>& load) { return TryPublish(*load); });
+	TextureCache::ReleaseCompletedUploads();
+}
+
+bool ModelManager::TryPublish(PendingLoad& load)
+{
+	// read before the stages, every stage of a finished job is queued by then
+	bool done = load.done;
+
+	CommandQueue& uploadQueue = CommandQueueManager::GetCommandQueue(QUEUETYPE::QUEUE_UPLOAD);
+
+	std::lock_guard<std::mutex> lock(load.stageMutex);
+	while (!load.stages.empty())
+	{
+		GLTFLoader::ModelStage& stage = load.stages.front();
+
+		// a texture taken from a load whose upload was never submitted will not become resident, neither this stage
+		// nor any later one can be shown
+		if (!load.uploadFailed)
+			for (const std::shared_ptr<Texture>& texture : stage.model->GetTextures())
+				if (texture->_uploadFenceValue == Texture::UPLOAD_FAILED)
+				{
+					PRINT("Loading ", load.path.string(), " failed: a shared texture was never uploaded");
+					load.uploadFailed = true;
+					break;
+				}
+
+		if (load.uploadFailed)
+		{
+			load.stages.pop_front();
+			continue;
+		}
+
+		if (!uploadQueue.IsFenceComplete(stage.fenceValue))
+			return false;
+
+		// a texture shared with a load that has not submitted (or finished) its upload yet holds this stage back as well
+		for (const std::shared_ptr<Texture>& texture : stage.model->GetTextures())
+			if (!uploadQueue.IsFenceComplete(texture->_uploadFenceValue))
+				return false;
+
+		// resident now, the upload heaps would otherwise hold a second copy of every texture for the lifetime of the model
+		if (GLTFLoader::releaseStagingCopies)
+			for (const std::shared_ptr<Texture>& texture : stage.model->GetTextures())
+				texture->ReleaseUploadHeap();
+
+		PublishStage(load, stage);
+
+		load.finalPublished = stage.isFinal;
+		load.stages.pop_front();
+	}
+
+	if (!done)
+		return false;
+
+	// a failed load keeps whatever stage it got to
+	if (!load.finalPublished)
+		_loadStates[load.handle] = LOAD_FAILED;
+
+	FinishImportReport(load);
+	return true;
+}
+
+void ModelManager::PublishStage(PendingLoad& load, GLTFLoader::ModelStage& stage)
+{
+	// GUI registration and _models are only touched on the render thread
+	std::shared_ptr<Model>& model = _handleModels[load.handle];
+	if (!model)
+	{
+		model = stage.model;
 		model->RegisterWithGUI();
+		_models.push_back(model);
+	}
+	else
+	{
+		model->TakeContent(*stage.model);
+	}
 
-		_models.push_back(std::move(model));
+	_loadStates[load.handle] = stage.isFinal ? LOAD_READY : LOAD_PARTIAL;
+
+	StageTiming timing;
+	timing.stage = stage.name;
+	timing.visibleMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - load.startTime).count();
+	timing.uploadBytes = stage.uploadBytes;
+	_importReports[load.handle].streamingStages.push_back(timing);
+
+	PRINT("Streaming: ", load.path.filename().string(), " | ", timing.stage, " visible after ", timing.visibleMs, "ms | ", timing.uploadBytes / 1024, "KB uploaded");
+}
+
+void ModelManager::FinishImportReport(PendingLoad& load)
+{
+	// the stages drawn so far were collected here, the rest comes from the load job
+	load.report.streamingStages = std::move(_importReports[load.handle].streamingStages);
+
+	// what the published model keeps besides its GPU copies
+	if (const std::shared_ptr<Model>& model = _handleModels[load.handle])
+	{
+		std::vector<const Texture*> textures;
+		for (const std::shared_ptr<Texture>& texture : model->GetTextures())
+			textures.push_back(texture.get());
+
+		std::sort(textures.begin(), textures.end());
+		textures.erase(std::unique(textures.begin(), textures.end()), textures.end());
+		for (const Texture* texture : textures)
+			load.report.retainedStagingBytes += texture->GetStagingBytes();
 	}
+	_importReports[load.handle] = std::move(load.report);
 
-	uploadContext.Finish(true);
+	ImportReport::Print(_importReports[load.handle]);
+}
+
+void ModelManager::WaitForLoads()
+{
+	while (!_pendingLoads.empty())
+	{
+		for (const std::shared_ptr<PendingLoad>& load : _pendingLoads)
+			load->done.wait(false);
+
+		CommandQueueManager::GetCommandQueue(QUEUETYPE::QUEUE_UPLOAD).WaitForFence();
+		Update();
+	}
+
+	// uploads of loads published in an earlier frame may still be held
+	CommandQueueManager::GetCommandQueue(QUEUETYPE::QUEUE_UPLOAD).WaitForFence();
+	TextureCache::ReleaseCompletedUploads();
+}
+
+ModelManager::LOADSTATE ModelManager::GetLoadState(ModelHandle handle) const
+{
+	return handle < _loadStates.size() ? _loadStates[handle] : LOAD_INVALID;
+}
+
+std::span<const ModelManager::StageTiming> ModelManager::GetStageTimings(ModelHandle handle) const
+{
+	return handle < _importReports.size() ? std::span<const StageTiming>(_importReports[handle].streamingStages) : std::span<const StageTiming>();
+}
+
+const ImportReport::AssetReport* ModelManager::GetImportReport(ModelHandle handle) const
+{
+	return handle < _importReports.size() ? &_importReports[handle] : nullptr;
+}
+
+bool ModelManager::WriteImportReport(const std::filesystem::path& path) const
+{
+	return ImportReport::WriteJson(_importReports, path);
+}
+
+std::shared_ptr<Model> ModelManager::GetModel(ModelHandle handle) const
+{
+	return handle < _handleModels.size() ? _handleModels[handle] : nullptr;
+}
+
+bool ModelManager::IsLoading() const
+{
+	return !_pendingLoads.empty();
 }
 
-void ModelManager::DrawAll(const ShaderPass& shaderPass, CommandContext& commandContext)
+void ModelManager::DrawAll(const ShaderPass& shaderPass, CommandContext& commandContext, const MeshProcessing::CullingCamera* cullingCamera)
 {
 	for (auto& model : _models)
 	{
-		model->DrawModel(shaderPass, commandContext.GetCommandList());
+		model->DrawModel(shaderPass, commandContext.GetCommandList(), cullingCamera);
 	}
 }
 
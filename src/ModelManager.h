@@ -2,20 +2,94 @@
 
 #include "pch.h"
 
+#include <atomic>
+#include <mutex>
+#include <deque>
+
 #include "GLTFLoader.h"
 #include "Model.h"
 #include "CommandQueue.h"
 #include "CommandContext.h"
+#include "JobSystem.h"
+#include "TextureCache.h"
+#include "ImportReport.h"
 
 class ModelManager
 {
+public:
+	enum LOADSTATE : int32_t
+	{
+		LOAD_INVALID = NOTOK,
+		LOAD_PENDING = 0,
+		LOAD_PARTIAL = 1, // an earlier streaming stage is drawn, the full one is still loading
+		LOAD_READY = 2,
+		LOAD_FAILED = 3
+	};
+
+	using ModelHandle = uint32_t;
+
+	// time from LoadModel until the stage was first drawn
+	using StageTiming = ImportReport::StreamingStage;
+
 public:
 	ModelManager() = default;
 
-	void LoadModel(const std::filesystem::path& path);
-	void DrawAll(const ShaderPass& shaderPass, CommandContext& commandContext);
+	// returns at once: parsing, processing and the upload run on the job system. The model is streamed in stages
+	// (see GLTFLoader::progressiveStreaming), each one is drawn once Update published it
+	ModelHandle LoadModel(const std::filesystem::path& path);
+	// returns at once as well, the files are parsed and processed concurrently and their final stages recorded into one
+	// upload batch. It is submitted with a single fence once every file is through, so the whole set becomes visible
+	// together instead of streaming in per file
+	std::vector<ModelHandle> LoadModels(std::span<const std::filesystem::path> paths);
+
+	// render thread, once per frame: publishes every stage whose uploads are resident, in order. Later stages swap
+	// their content into the model drawn so far, so a frame always sees one complete stage
+	void Update();
+	// blocks until every load is finished and published (or failed)
+	void WaitForLoads();
+
+	LOADSTATE GetLoadState(ModelHandle handle) const;
+	std::span<const StageTiming> GetStageTimings(ModelHandle handle) const;
+	// per stage timings and byte counts of the load, complete once the load is finished (see WaitForLoads)
+	const ImportReport::AssetReport* GetImportReport(ModelHandle handle) const;
+	bool WriteImportReport(const std::filesystem::path& path) const;
+	std::shared_ptr<Model> GetModel(ModelHandle handle) const;
+	bool IsLoading() const;
+
+	void DrawAll(const ShaderPass& shaderPass, CommandContext& commandContext, const MeshProcessing::CullingCamera* cullingCamera = nullptr);
 	void DrawAllBoundingBoxes(const ShaderPass& shaderPass, CommandContext& commandContext);
 
 private:
+	// shared between the render thread and the load job, the job pushes stages until it sets done
+	struct PendingLoad
+	{
+		ModelHandle handle = 0;
+		std::filesystem::path path;
+		std::chrono::high_resolution_clock::time_point startTime;
+		std::mutex stageMutex;
+		std::deque<GLTFLoader::ModelStage> stages;
+		ImportReport::Recorder recorder;
+		ImportReport::AssetReport report; // written by the job before it sets done
+		bool finalPublished = false;
+		bool uploadFailed = false;
+		std::atomic<bool> done = false;
+	};
+
+	std::shared_ptr<PendingLoad> AddPendingLoad(const std::filesystem::path& path);
+	// runs on the job system, false if the load failed
+	static bool StreamLoad(PendingLoad& load, const GLTFLoader::StageCallback& onStage, GLTFLoader::UploadBatch* batch = nullptr);
+	static void FinishLoad(PendingLoad& load, bool streamedModel);
+
+	// true once the load job is done and its final stage is published (or it failed)
+	bool TryPublish(PendingLoad& load);
+	void PublishStage(PendingLoad& load, GLTFLoader::ModelStage& stage);
+	void FinishImportReport(PendingLoad& load);
+
 	std::vector<std::shared_ptr<Model>> _models;
+	std::vector<std::shared_ptr<PendingLoad>> _pendingLoads;
+
+	// indexed by handle
+	std::vector<LOADSTATE> _loadStates;
+	std::vector<std::shared_ptr<Model>> _handleModels;
+	std::vector<ImportReport::AssetReport> _importReports;
 };
\ No newline at end of file
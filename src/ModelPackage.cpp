@@ -0,0 +1,236 @@
+#include "ModelPackage.h"
+
+namespace ModelPackage
+{
+	void WriteModel(PackageWriter& writer, const ModelData& data)
+	{
+		std::vector<uint8_t> strings;
+		auto addString = [&](const std::string& string, uint32_t& offset, uint32_t& length)
+		{
+			offset = static_cast<uint32_t>(strings.size());
+			length = static_cast<uint32_t>(string.size());
+			strings.insert(strings.end(), string.begin(), string.end());
+		};
+
+		ModelInfoRecord info;
+		info.meshCount = static_cast<uint32_t>(data.meshes.size());
+		info.materialCount = static_cast<uint32_t>(data.materials.size());
+		info.textureCount = static_cast<uint32_t>(data.textures.size());
+		info.nodeCount = static_cast<uint32_t>(data.nodes.size());
+		addString(data.name, info.nameOffset, info.nameLength);
+
+		// primitives are stored flat, the per primitive blobs are indexed by the flat primitive index
+		std::vector<PrimitiveRecord> primitives;
+		for (size_t meshIndex = 0; meshIndex < data.meshes.size(); ++meshIndex)
+		{
+			for (const PrimitiveData& primitive : data.meshes[meshIndex])
+			{
+				uint32_t primitiveIndex = static_cast<uint32_t>(primitives.size());
+
+				PrimitiveRecord& record = primitives.emplace_back();
+				record.meshIndex = static_cast<uint32_t>(meshIndex);
+				record.materialIndex = primitive.materialIndex;
+				record.vertexCount = static_cast<uint32_t>(primitive.vertices.size());
+				record.indexCount = static_cast<uint32_t>(primitive.indices.size());
+
+				writer.AddArray(BLOB_VERTICES, primitiveIndex, 0, primitive.vertices);
+				writer.AddArray(BLOB_INDICES, primitiveIndex, 0, primitive.indices);
+				writer.AddArray(BLOB_MESHLETS, primitiveIndex, 0, primitive.meshlets);
+				writer.AddArray(BLOB_LODS, primitiveIndex, 0, primitive.lods);
+			}
+		}
+		info.primitiveCount = static_cast<uint32_t>(primitives.size());
+
+		std::vector<MaterialRecord> materials;
+		materials.reserve(data.materials.size());
+		for (const MaterialData& material : data.materials)
+		{
+			MaterialRecord& record = materials.emplace_back();
+			record.pbrFactors = material.pbrFactors;
+			record.alphaMode = static_cast<uint32_t>(material.alphaMode);
+			std::copy(std::begin(material.textureIndices), std::end(material.textureIndices), record.textureIndices);
+		}
+
+		std::vector<TextureRecord> textures;
+		textures.reserve(data.textures.size());
+		for (const TextureJob& textureJob : data.textures)
+		{
+			TextureRecord& record = textures.emplace_back();
+			record.contentHash = textureJob.contentHash;
+			record.textureType = static_cast<uint32_t>(textureJob.textureType);
+			record.hasImage = textureJob.imageIndex.has_value() ? 1 : 0;
+		}
+
+		std::vector<NodeRecord> nodes;
+		std::vector<int32_t> children;
+		nodes.reserve(data.nodes.size());
+		for (const NodeData& node : data.nodes)
+		{
+			NodeRecord& record = nodes.emplace_back();
+			record.meshIndex = node.meshIndex;
+			record.parentIndex = node.parentIndex;
+			record.childOffset = static_cast<uint32_t>(children.size());
+			record.childCount = static_cast<uint32_t>(node.children.size());
+			record.localMatrix = node.localMatrix;
+			addString(node.name, record.nameOffset, record.nameLength);
+
+			children.insert(children.end(), node.children.begin(), node.children.end());
+		}
+
+		writer.AddOwnedArray(BLOB_MODELINFO, 0, 0, std::vector<ModelInfoRecord>{ info });
+		writer.AddOwnedArray(BLOB_PRIMITIVES, 0, 0, primitives);
+		writer.AddOwnedArray(BLOB_MATERIALS, 0, 0, materials);
+		writer.AddOwnedArray(BLOB_TEXTURES, 0, 0, textures);
+		writer.AddOwnedArray(BLOB_NODES, 0, 0, nodes);
+		writer.AddOwnedArray(BLOB_NODECHILDREN, 0, 0, children);
+		writer.AddOwnedBlob(BLOB_STRINGS, 0, 0, std::move(strings));
+	}
+
+	void WriteTexture(PackageWriter& writer, uint32_t textureIndex, const ScratchImage& scratchImage)
+	{
+		const TexMetadata& metadata = scratchImage.GetMetadata();
+		if (metadata.dimension != TEX_DIMENSION_TEXTURE2D || metadata.arraySize != 1 || metadata.depth != 1)
+			ThrowException("only single 2D textures can be written to a package");
+
+		TextureInfoRecord info;
+		info.width = static_cast<uint32_t>(metadata.width);
+		info.height = static_cast<uint32_t>(metadata.height);
+		info.mipLevels = static_cast<uint32_t>(metadata.mipLevels);
+		info.format = static_cast<uint32_t>(metadata.format);
+
+		std::vector<MipRecord> mips(metadata.mipLevels);
+		for (uint32_t mip = 0; mip < info.mipLevels; ++mip)
+		{
+			const Image* image = scratchImage.GetImage(mip, 0, 0);
+			mips[mip].width = static_cast<uint32_t>(image->width);
+			mips[mip].height = static_cast<uint32_t>(image->height);
+			mips[mip].rowPitch = image->rowPitch;
+			mips[mip].slicePitch = image->slicePitch;
+
+			// one blob per mip -> every level starts page aligned and can be uploaded straight from the mapping
+			writer.AddBlob(BLOB_TEXTUREMIP, textureIndex, mip, image->pixels, image->slicePitch);
+		}
+
+		writer.AddOwnedArray(BLOB_TEXTUREINFO, textureIndex, 0, std::vector<TextureInfoRecord>{ info });
+		writer.AddOwnedArray(BLOB_TEXTUREMIPINFO, textureIndex, 0, mips);
+	}
+
+	bool ReadModel(const PackageReader& reader, ModelView& view)
+	{
+		const ModelInfoRecord* info = reader.GetRecord<ModelInfoRecord>(BLOB_MODELINFO);
+		if (!info)
+			return false;
+
+		std::span<const PrimitiveRecord> primitives = reader.GetArray<PrimitiveRecord>(BLOB_PRIMITIVES);
+		std::span<const MaterialRecord> materials = reader.GetArray<MaterialRecord>(BLOB_MATERIALS);
+		std::span<const TextureRecord> textures = reader.GetArray<TextureRecord>(BLOB_TEXTURES);
+		std::span<const NodeRecord> nodes = reader.GetArray<NodeRecord>(BLOB_NODES);
+		std::span<const int32_t> children = reader.GetArray<int32_t>(BLOB_NODECHILDREN);
+		std::span<const uint8_t> strings = reader.GetBlob(BLOB_STRINGS);
+
+		if (primitives.size() != info->primitiveCount || materials.size() != info->materialCount
+			|| textures.size() != info->textureCount || nodes.size() != info->nodeCount)
+			return false;
+
+		auto readString = [&](uint32_t offset, uint32_t length, std::string& string)
+		{
+			if (static_cast<uint64_t>(offset) + length > strings.size())
+				return false;
+			string.assign(reinterpret_cast<const char*>(strings.data()) + offset, length);
+			return true;
+		};
+
+		if (!readString(info->nameOffset, info->nameLength, view.name))
+			return false;
+
+		view.meshes.assign(info->meshCount, {});
+		for (uint32_t primitiveIndex = 0; primitiveIndex < info->primitiveCount; ++primitiveIndex)
+		{
+			const PrimitiveRecord& record = primitives[primitiveIndex];
+
+			PrimitiveView primitive;
+			primitive.vertices = reader.GetArray<Vertex>(BLOB_VERTICES, primitiveIndex);
+			primitive.indices = reader.GetArray<uint32_t>(BLOB_INDICES, primitiveIndex);
+			primitive.meshlets = reader.GetArray<MeshProcessing::Meshlet>(BLOB_MESHLETS, primitiveIndex);
+			primitive.lods = reader.GetArray<MeshProcessing::LodLevel>(BLOB_LODS, primitiveIndex);
+			primitive.materialIndex = record.materialIndex;
+
+			if (record.meshIndex >= info->meshCount || primitive.vertices.size() != record.vertexCount || primitive.indices.size() != record.indexCount)
+				return false;
+
+			for (const MeshProcessing::LodLevel& lod : primitive.lods)
+				if (static_cast<uint64_t>(lod.indexOffset) + lod.indexCount > primitive.indices.size() || static_cast<uint64_t>(lod.meshletOffset) + lod.meshletCount > primitive.meshlets.size())
+					return false;
+
+			view.meshes[record.meshIndex].push_back(primitive);
+		}
+
+		view.materials.resize(materials.size());
+		for (size_t i = 0; i < materials.size(); ++i)
+		{
+			view.materials[i].pbrFactors = materials[i].pbrFactors;
+			view.materials[i].alphaMode = static_cast<fastgltf::AlphaMode>(materials[i].alphaMode);
+			std::copy(std::begin(materials[i].textureIndices), std::end(materials[i].textureIndices), view.materials[i].textureIndices);
+		}
+
+		view.textures.resize(textures.size());
+		for (size_t i = 0; i < textures.size(); ++i)
+		{
+			view.textures[i].textureType = static_cast<Texture::TEXTURETYPE>(textures[i].textureType);
+			view.textures[i].contentHash = textures[i].contentHash;
+			view.textures[i].hasImage = textures[i].hasImage != 0;
+		}
+
+		view.nodes.resize(nodes.size());
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			const NodeRecord& record = nodes[i];
+			NodeData& node = view.nodes[i];
+
+			if (static_cast<uint64_t>(record.childOffset) + record.childCount > children.size() || !readString(record.nameOffset, record.nameLength, node.name))
+				return false;
+
+			node.meshIndex = record.meshIndex;
+			node.parentIndex = record.parentIndex;
+			node.children.assign(children.begin() + record.childOffset, children.begin() + record.childOffset + record.childCount);
+			node.localMatrix = record.localMatrix;
+		}
+
+		return true;
+	}
+
+	bool ReadTexture(const PackageReader& reader, uint32_t textureIndex, TexMetadata& metadata, std::vector<Image>& images)
+	{
+		const TextureInfoRecord* info = reader.GetRecord<TextureInfoRecord>(BLOB_TEXTUREINFO, textureIndex);
+		std::span<const MipRecord> mips = reader.GetArray<MipRecord>(BLOB_TEXTUREMIPINFO, textureIndex);
+		if (!info || info->mipLevels == 0 || mips.size() != info->mipLevels)
+			return false;
+
+		metadata = {};
+		metadata.width = info->width;
+		metadata.height = info->height;
+		metadata.depth = 1;
+		metadata.arraySize = 1;
+		metadata.mipLevels = info->mipLevels;
+		metadata.format = static_cast<DXGI_FORMAT>(info->format);
+		metadata.dimension = TEX_DIMENSION_TEXTURE2D;
+
+		images.resize(info->mipLevels);
+		for (uint32_t mip = 0; mip < info->mipLevels; ++mip)
+		{
+			std::span<const uint8_t> pixels = reader.GetBlob(BLOB_TEXTUREMIP, textureIndex, mip);
+			if (pixels.size() < mips[mip].slicePitch)
+				return false;
+
+			images[mip].width = mips[mip].width;
+			images[mip].height = mips[mip].height;
+			images[mip].format = metadata.format;
+			images[mip].rowPitch = static_cast<size_t>(mips[mip].rowPitch);
+			images[mip].slicePitch = static_cast<size_t>(mips[mip].slicePitch);
+			// Image has no const variant, the pixels are only ever read while recording the upload
+			images[mip].pixels = const_cast<uint8_t*>(pixels.data());
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "pch.h"
+
+#include "ModelData.h"
+#include "PackageFile.h"
+
+// (de)serialization of ModelData into package blobs, shared by the derived data cache and cooked scenes
+namespace ModelPackage
+{
+	// cooked scene packages written by artisDX-cook
+	constexpr const char* PACKAGE_EXTENSION = ".adxpkg";
+	// on-disk layout of the blobs below (and of the structs they hold), independent of DerivedDataCache::PROCESSING_VERSION
+	// so shipped packages stay loadable when only the processing changes. A layout change bumps both
+	constexpr uint32_t PACKAGE_VERSION = 1;
+
+	enum BLOBTYPE : uint32_t
+	{
+		BLOB_MODELINFO = 1,
+		BLOB_STRINGS = 2,
+		BLOB_PRIMITIVES = 3,
+		BLOB_VERTICES = 4,
+		BLOB_INDICES = 5,
+		BLOB_MATERIALS = 6,
+		BLOB_TEXTURES = 7,
+		BLOB_NODES = 8,
+		BLOB_NODECHILDREN = 9,
+		BLOB_TEXTUREINFO = 10,
+		BLOB_TEXTUREMIPINFO = 11,
+		BLOB_TEXTUREMIP = 12,
+		BLOB_MESHLETS = 13,
+		BLOB_LODS = 14
+	};
+
+	struct ModelInfoRecord
+	{
+		uint32_t meshCount = 0;
+		uint32_t primitiveCount = 0;
+		uint32_t materialCount = 0;
+		uint32_t textureCount = 0;
+		uint32_t nodeCount = 0;
+		uint32_t nameOffset = 0;
+		uint32_t nameLength = 0;
+		uint32_t reserved = 0;
+	};
+
+	struct PrimitiveRecord
+	{
+		uint32_t meshIndex = 0;
+		int32_t materialIndex = NOTOK;
+		uint32_t vertexCount = 0;
+		uint32_t indexCount = 0;
+	};
+
+	struct MaterialRecord
+	{
+		Material::PBRFactors pbrFactors;
+		uint32_t alphaMode = 0;
+		int32_t textureIndices[Texture::TEXTURETYPE_COUNT] = {};
+	};
+
+	struct TextureRecord
+	{
+		uint64_t contentHash = 0;
+		uint32_t textureType = 0;
+		uint32_t hasImage = 0;
+	};
+
+	struct NodeRecord
+	{
+		int32_t meshIndex = NOTOK;
+		int32_t parentIndex = -1;
+		uint32_t childOffset = 0;
+		uint32_t childCount = 0;
+		uint32_t nameOffset = 0;
+		uint32_t nameLength = 0;
+		XMFLOAT4X4 localMatrix = {};
+	};
+
+	struct TextureInfoRecord
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 0;
+		uint32_t format = 0;
+	};
+
+	struct MipRecord
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint64_t rowPitch = 0;
+		uint64_t slicePitch = 0;
+	};
+
+	struct TextureView
+	{
+		Texture::TEXTURETYPE textureType = Texture::TEXTURETYPE::TEXTURE_ALBEDO;
+		uint64_t contentHash = 0;
+		bool hasImage = false;
+	};
+
+	// geometry points into the package mapping, everything else is copied out (small)
+	struct ModelView
+	{
+		std::string name;
+		std::vector<std::vector<PrimitiveView>> meshes;
+		std::vector<MaterialData> materials;
+		std::vector<TextureView> textures;
+		std::vector<NodeData> nodes;
+	};
+
+	void WriteModel(PackageWriter& writer, const ModelData& data);
+	void WriteTexture(PackageWriter& writer, uint32_t textureIndex, const ScratchImage& scratchImage);
+
+	bool ReadModel(const PackageReader& reader, ModelView& view);
+	bool ReadTexture(const PackageReader& reader, uint32_t textureIndex, TexMetadata& metadata, std::vector<Image>& images);
+}
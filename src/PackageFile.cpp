@@ -0,0 +1,156 @@
+#include "PackageFile.h"
+
+#include <atomic>
+
+void PackageWriter::AddBlob(uint32_t type, uint32_t index, uint32_t subIndex, const void* data, size_t size)
+{
+	PackageFile::TocEntry entry;
+	entry.type = type;
+	entry.index = index;
+	entry.subIndex = subIndex;
+	entry.size = size;
+
+	_toc.push_back(entry);
+	_blobs.emplace_back(static_cast<const uint8_t*>(data), size);
+}
+
+void PackageWriter::AddOwnedBlob(uint32_t type, uint32_t index, uint32_t subIndex, std::vector<uint8_t> data)
+{
+	std::vector<uint8_t>& owned = _ownedBlobs.emplace_back(std::move(data));
+	AddBlob(type, index, subIndex, owned.data(), owned.size());
+}
+
+bool PackageWriter::WriteToFile(const std::filesystem::path& path, uint32_t version, uint64_t* writtenBytes) const
+{
+	auto alignUp = [](uint64_t value) { return (value + PackageFile::BLOB_ALIGNMENT - 1) & ~(PackageFile::BLOB_ALIGNMENT - 1); };
+
+	std::vector<PackageFile::TocEntry> toc = _toc;
+
+	uint64_t offset = alignUp(sizeof(PackageFile::Header) + toc.size() * sizeof(PackageFile::TocEntry));
+	for (PackageFile::TocEntry& entry : toc)
+	{
+		entry.offset = offset;
+		offset = alignUp(offset + entry.size);
+	}
+
+	PackageFile::Header header;
+	header.version = version;
+	header.blobCount = static_cast<uint32_t>(toc.size());
+	header.fileSize = offset;
+
+	std::error_code errorCode;
+	std::filesystem::create_directories(path.parent_path(), errorCode);
+
+	// unique per write, concurrent writers of the same entry (e.g. two loads sharing a texture) must not share a temp file
+	static std::atomic<uint64_t> tempIncrementor = 0;
+	std::filesystem::path tempPath = path;
+	tempPath += "." + std::to_string(GetCurrentProcessId()) + "_" + std::to_string(tempIncrementor++) + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+
+		static const uint8_t padding[PackageFile::BLOB_ALIGNMENT] = {};
+		auto padTo = [&](uint64_t target)
+		{
+			uint64_t position = static_cast<uint64_t>(file.tellp());
+			if (target > position)
+				file.write(reinterpret_cast<const char*>(padding), static_cast<std::streamsize>(target - position));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(toc.data()), static_cast<std::streamsize>(toc.size() * sizeof(PackageFile::TocEntry)));
+
+		for (size_t i = 0; i < toc.size(); ++i)
+		{
+			padTo(toc[i].offset);
+			if (!_blobs[i].empty())
+				file.write(reinterpret_cast<const char*>(_blobs[i].data()), static_cast<std::streamsize>(_blobs[i].size()));
+		}
+		padTo(header.fileSize);
+		file.close();
+
+		if (!file)
+		{
+			std::filesystem::remove(tempPath, errorCode);
+			return false;
+		}
+	}
+
+	std::filesystem::rename(tempPath, path, errorCode);
+	if (errorCode)
+	{
+		std::filesystem::remove(tempPath, errorCode);
+		return false;
+	}
+
+	if (writtenBytes)
+		*writtenBytes = header.fileSize;
+
+	return true;
+}
+
+bool PackageReader::Open(const std::filesystem::path& path, uint32_t expectedVersion, uint32_t* foundVersion)
+{
+	Close();
+
+	if (!_file.Open(path))
+		return false;
+
+	if (_file.GetSize() < sizeof(PackageFile::Header))
+	{
+		Close();
+		return false;
+	}
+
+	const PackageFile::Header* header = reinterpret_cast<const PackageFile::Header*>(_file.GetData());
+	if (foundVersion && header->magic == PackageFile::MAGIC)
+		*foundVersion = header->version;
+
+	uint64_t tocEnd = sizeof(PackageFile::Header) + static_cast<uint64_t>(header->blobCount) * sizeof(PackageFile::TocEntry);
+	if (header->magic != PackageFile::MAGIC || header->version != expectedVersion || header->fileSize != _file.GetSize() || tocEnd > _file.GetSize())
+	{
+		Close();
+		return false;
+	}
+
+	const PackageFile::TocEntry* toc = reinterpret_cast<const PackageFile::TocEntry*>(_file.GetData() + sizeof(PackageFile::Header));
+	for (uint32_t i = 0; i < header->blobCount; ++i)
+	{
+		if (toc[i].offset + toc[i].size > _file.GetSize())
+		{
+			Close();
+			return false;
+		}
+		_entries.try_emplace(MakeKey(toc[i].type, toc[i].index, toc[i].subIndex), &toc[i]);
+	}
+
+	return true;
+}
+
+void PackageReader::Close()
+{
+	_entries.clear();
+	_file.Close();
+}
+
+std::span<const uint8_t> PackageReader::GetBlob(uint32_t type, uint32_t index, uint32_t subIndex) const
+{
+	auto it = _entries.find(MakeKey(type, index, subIndex));
+	if (it == _entries.end())
+		return {};
+
+	return { _file.GetData() + it->second->offset, static_cast<size_t>(it->second->size) };
+}
+
+bool PackageReader::HasBlob(uint32_t type, uint32_t index, uint32_t subIndex) const
+{
+	return _entries.contains(MakeKey(type, index, subIndex));
+}
+
+uint64_t PackageReader::MakeKey(uint32_t type, uint32_t index, uint32_t subIndex)
+{
+	// type and subIndex are small (blob kinds, mip levels), index gets the upper half
+	return (static_cast<uint64_t>(index) << 32) | (static_cast<uint64_t>(type & 0xFFFF) << 16) | (subIndex & 0xFFFF);
+}
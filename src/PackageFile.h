@@ -0,0 +1,105 @@
+#pragma once
+
+#include "pch.h"
+
+#include "MappedFile.h"
+
+// Binary container used for derived data and cooked scenes:
+// [Header][TocEntry * blobCount][padding][blob 0][padding][blob 1]...
+// every blob starts on a page boundary so it can be used straight from a read-only mapping.
+namespace PackageFile
+{
+	constexpr uint32_t MAGIC = 0x50584441; // "ADXP"
+	constexpr uint64_t BLOB_ALIGNMENT = 4096;
+
+	struct Header
+	{
+		uint32_t magic = MAGIC;
+		uint32_t version = 0;
+		uint32_t blobCount = 0;
+		uint32_t reserved = 0;
+		uint64_t fileSize = 0;
+	};
+
+	struct TocEntry
+	{
+		uint32_t type = 0;
+		uint32_t index = 0;
+		uint32_t subIndex = 0;
+		uint32_t reserved = 0;
+		uint64_t offset = 0;
+		uint64_t size = 0;
+	};
+}
+
+class PackageWriter
+{
+public:
+	PackageWriter() = default;
+
+	// the data has to stay alive until WriteToFile, use AddOwnedBlob for temporaries
+	void AddBlob(uint32_t type, uint32_t index, uint32_t subIndex, const void* data, size_t size);
+	void AddOwnedBlob(uint32_t type, uint32_t index, uint32_t subIndex, std::vector<uint8_t> data);
+
+	template<typename T>
+	void AddArray(uint32_t type, uint32_t index, uint32_t subIndex, const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		AddBlob(type, index, subIndex, values.data(), values.size() * sizeof(T));
+	}
+
+	template<typename T>
+	void AddOwnedArray(uint32_t type, uint32_t index, uint32_t subIndex, const std::vector<T>& values)
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		std::vector<uint8_t> bytes(values.size() * sizeof(T));
+		if (!bytes.empty())
+			memcpy(bytes.data(), values.data(), bytes.size());
+		AddOwnedBlob(type, index, subIndex, std::move(bytes));
+	}
+
+	// writes to a temporary file first and renames it, readers never see half written packages
+	bool WriteToFile(const std::filesystem::path& path, uint32_t version, uint64_t* writtenBytes = nullptr) const;
+
+private:
+	std::vector<PackageFile::TocEntry> _toc;
+	std::vector<std::span<const uint8_t>> _blobs;
+	std::list<std::vector<uint8_t>> _ownedBlobs;
+};
+
+class PackageReader
+{
+public:
+	PackageReader() = default;
+
+	// foundVersion receives the version of any file with a valid header, also when it is not the expected one
+	bool Open(const std::filesystem::path& path, uint32_t expectedVersion, uint32_t* foundVersion = nullptr);
+	void Close();
+
+	bool IsOpen() const { return _file.IsOpen(); }
+	uint64_t GetFileSize() const { return _file.GetSize(); }
+
+	std::span<const uint8_t> GetBlob(uint32_t type, uint32_t index = 0, uint32_t subIndex = 0) const;
+	bool HasBlob(uint32_t type, uint32_t index = 0, uint32_t subIndex = 0) const;
+
+	template<typename T>
+	std::span<const T> GetArray(uint32_t type, uint32_t index = 0, uint32_t subIndex = 0) const
+	{
+		static_assert(std::is_trivially_copyable_v<T>);
+		std::span<const uint8_t> blob = GetBlob(type, index, subIndex);
+		return { reinterpret_cast<const T*>(blob.data()), blob.size() / sizeof(T) };
+	}
+
+	template<typename T>
+	const T* GetRecord(uint32_t type, uint32_t index = 0, uint32_t subIndex = 0) const
+	{
+		std::span<const T> records = GetArray<T>(type, index, subIndex);
+		return records.empty() ? nullptr : records.data();
+	}
+
+private:
+	static uint64_t MakeKey(uint32_t type, uint32_t index, uint32_t subIndex);
+
+	MappedFile _file;
+	std::unordered_map<uint64_t, const PackageFile::TocEntry*> _entries;
+};
@@ -1,29 +1,46 @@
 #include "Primitive.h"
 
-Primitive::Primitive(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, int32_t materialIndex)
+Primitive::Primitive(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const MeshProcessing::LodLevel> lods, std::span<const MeshProcessing::Meshlet> meshlets, int32_t materialIndex)
 {
 	_vertexCount = static_cast<uint32_t>(vertices.size());
-	auto vertexBufferSize = vertices.size() * sizeof(Vertex);
+	auto vertexBufferSize = vertices.size() * (VertexFormat::PositionStream::stride + VertexFormat::AttributeStream::stride);
 	_vertexBuffer = CreateBuffer(vertexBufferSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
 	_vertexBuffer->SetName(L"VertexBufferResource");
 
+	// 16 bit indices whenever every vertex is addressable with them
 	_indexCount = static_cast<uint32_t>(indices.size());
-	auto indexBufferSize = _indexCount * sizeof(uint32_t);
+	_indexFormat = vertices.size() < 65536 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+	auto indexBufferSize = _indexCount * (_indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(uint16_t) : sizeof(uint32_t));
 	_indexBuffer = CreateBuffer(indexBufferSize, D3D12_HEAP_TYPE_UPLOAD, D3D12_RESOURCE_STATE_GENERIC_READ);
 	_indexBuffer->SetName(L"IndexBufferResource");
 
-	UploadBuffers(vertices, static_cast<uint32_t>(vertexBufferSize), indices, static_cast<uint32_t>(indexBufferSize));
+	UploadBuffers(vertices, indices);
 
-	_vertexBufferView.BufferLocation = _vertexBuffer->GetGPUVirtualAddress();
-	_vertexBufferView.SizeInBytes = static_cast<uint32_t>(vertexBufferSize);
-	_vertexBufferView.StrideInBytes = sizeof(Vertex);
+	// same order VertexFormat::PackStreams writes them in
+	D3D12_GPU_VIRTUAL_ADDRESS streamLocation = _vertexBuffer->GetGPUVirtualAddress();
+	for (uint32_t stream = 0; stream < VertexFormat::STREAM_COUNT; ++stream)
+	{
+		_vertexBufferViews[stream].BufferLocation = streamLocation;
+		_vertexBufferViews[stream].SizeInBytes = _vertexCount * VertexFormat::streamStrides[stream];
+		_vertexBufferViews[stream].StrideInBytes = VertexFormat::streamStrides[stream];
+		streamLocation += _vertexBufferViews[stream].SizeInBytes;
+	}
 
 	_indexBufferView.BufferLocation = _indexBuffer->GetGPUVirtualAddress();
 	_indexBufferView.SizeInBytes = static_cast<uint32_t>(indexBufferSize);
-	_indexBufferView.Format = DXGI_FORMAT_R32_UINT;
+	_indexBufferView.Format = _indexFormat;
 
 	_materialIndex = materialIndex;
 	_aabb = AABB(vertices);
+	XMVECTOR boundsMin = XMLoadFloat3(&_aabb.GetMin());
+	XMVECTOR boundsMax = XMLoadFloat3(&_aabb.GetMax());
+	XMStoreFloat3(&_boundsCenter, (boundsMin + boundsMax) * 0.5f);
+	_boundsRadius = XMVectorGetX(XMVector3Length(boundsMax - boundsMin)) * 0.5f;
+
+	_meshlets.assign(meshlets.begin(), meshlets.end());
+	_lods.assign(lods.begin(), lods.end());
+	if (_lods.empty())
+		_lods.push_back({ 0, _indexCount, 0, static_cast<uint32_t>(_meshlets.size()) });
 }
 
 MSWRL::ComPtr<ID3D12Resource> Primitive::CreateBuffer(uint64_t size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState)
@@ -62,26 +79,92 @@ MSWRL::ComPtr<ID3D12Resource> Primitive::CreateBuffer(uint64_t size, D3D12_HEAP_
 	return buffer;
 }
 
-void Primitive::UploadBuffers(std::vector<Vertex>& vertices, uint32_t vertexBufferSize, std::vector<uint32_t>& indices, uint32_t indexBufferSize)
+void Primitive::UploadBuffers(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
 {
-	// Upload vertex data
+	// Upload vertex data, every stream packed into the GPU format straight into the mapped buffer
 	uint8_t* pVertexDataBegin = nullptr;
 	D3D12_RANGE readRange(0, 0); // We do not intend to read from this resource on the CPU.
 	ThrowIfFailed(_vertexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pVertexDataBegin)));
-	memcpy(pVertexDataBegin, vertices.data(), vertexBufferSize);
+	VertexFormat::PackStreams(vertices, pVertexDataBegin);
 	_vertexBuffer->Unmap(0, nullptr);
 
 	// Upload index data
 	void* pIndexDataBegin = nullptr;
 	ThrowIfFailed(_indexBuffer->Map(0, &readRange, reinterpret_cast<void**>(&pIndexDataBegin)));
-	memcpy(pIndexDataBegin, indices.data(), indexBufferSize);
+	if (_indexFormat == DXGI_FORMAT_R16_UINT)
+	{
+		uint16_t* indices16 = static_cast<uint16_t*>(pIndexDataBegin);
+		for (size_t i = 0; i < indices.size(); ++i)
+			indices16[i] = static_cast<uint16_t>(indices[i]);
+	}
+	else
+	{
+		memcpy(pIndexDataBegin, indices.data(), indices.size_bytes());
+	}
 	_indexBuffer->Unmap(0, nullptr);
 }
 
-void Primitive::BindPrimitiveData(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
+void Primitive::BindVertexStreams(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask)
 {
-	commandList->IASetVertexBuffers(0, 1, &_vertexBufferView);
+	for (uint32_t stream = 0; stream < VertexFormat::STREAM_COUNT; ++stream)
+		if (vertexStreamMask & (1u << stream))
+			commandList->IASetVertexBuffers(stream, 1, &_vertexBufferViews[stream]);
+}
+
+void Primitive::BindPrimitiveData(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask)
+{
+	BindVertexStreams(commandList, vertexStreamMask);
 	commandList->IASetIndexBuffer(&_indexBufferView);
 	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	commandList->DrawIndexedInstanced(_indexCount, 1, 0, 0, 0);
+	commandList->DrawIndexedInstanced(_lods[0].indexCount, 1, _lods[0].indexOffset, 0, 0);
 }
+
+void Primitive::DrawCulled(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask, const MeshProcessing::CullingView& cullingView)
+{
+	const MeshProcessing::LodLevel& lod = _lods[SelectLod(cullingView)];
+
+	BindVertexStreams(commandList, vertexStreamMask);
+	commandList->IASetIndexBuffer(&_indexBufferView);
+	commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+
+	if (lod.meshletCount == 0)
+	{
+		commandList->DrawIndexedInstanced(lod.indexCount, 1, lod.indexOffset, 0, 0);
+		return;
+	}
+
+	std::span<const MeshProcessing::Meshlet> meshlets(_meshlets.data() + lod.meshletOffset, lod.meshletCount);
+
+	static thread_local std::vector<uint32_t> visibleMeshlets;
+	MeshProcessing::CullMeshlets(meshlets, cullingView, visibleMeshlets);
+	if (visibleMeshlets.empty())
+		return;
+
+	// meshlets are stored back to back in the index buffer, neighbouring visible ones become one draw
+	uint32_t rangeStart = meshlets[visibleMeshlets[0]].indexOffset;
+	uint32_t rangeEnd = rangeStart + meshlets[visibleMeshlets[0]].indexCount;
+	for (size_t i = 1; i < visibleMeshlets.size(); ++i)
+	{
+		const MeshProcessing::Meshlet& meshlet = meshlets[visibleMeshlets[i]];
+		if (meshlet.indexOffset != rangeEnd)
+		{
+			commandList->DrawIndexedInstanced(rangeEnd - rangeStart, 1, rangeStart, 0, 0);
+			rangeStart = meshlet.indexOffset;
+		}
+		rangeEnd = meshlet.indexOffset + meshlet.indexCount;
+	}
+	commandList->DrawIndexedInstanced(rangeEnd - rangeStart, 1, rangeStart, 0, 0);
+}
+
+uint32_t Primitive::SelectLod(const MeshProcessing::CullingView& cullingView) const
+{
+	return MeshProcessing::SelectLod(_lods, _boundsCenter, _boundsRadius, cullingView, MeshProcessing::lodPixelError);
+}
+
+uint64_t Primitive::GetBufferBytes() const
+{
+	uint64_t bytes = _indexBufferView.SizeInBytes;
+	for (const D3D12_VERTEX_BUFFER_VIEW& view : _vertexBufferViews)
+		bytes += view.SizeInBytes;
+	return bytes;
+}
\ No newline at end of file
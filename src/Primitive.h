@@ -4,25 +4,41 @@
 
 #include "D3D12Core.h"
 #include "AABB.h"
+#include "VertexFormat.h"
+#include "MeshProcessing.h"
 
 class Primitive
 {
 public:
 	Primitive() = default;
-	Primitive(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, int32_t materialIndex);
-	void BindPrimitiveData(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
+	Primitive(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::span<const MeshProcessing::LodLevel> lods, std::span<const MeshProcessing::Meshlet> meshlets, int32_t materialIndex);
+	// draws LOD 0, vertexStreamMask selects the streams that get bound (ShaderPass::_vertexStreamMask)
+	void BindPrimitiveData(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask);
+	// picks the lod from the projected error and draws only its meshlets that pass the culling view,
+	// levels without meshlets are drawn as a whole
+	void DrawCulled(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask, const MeshProcessing::CullingView& cullingView);
+	uint32_t SelectLod(const MeshProcessing::CullingView& cullingView) const;
+	// vertex + index buffer size
+	uint64_t GetBufferBytes() const;
 
 	MSWRL::ComPtr<ID3D12Resource> CreateBuffer(uint64_t size, D3D12_HEAP_TYPE heapType, D3D12_RESOURCE_STATES initialState);
-	void UploadBuffers(std::vector<Vertex>& vertices, uint32_t vertexBufferSize, std::vector<uint32_t>& indices, uint32_t indexBufferSize);
+	void UploadBuffers(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+	void BindVertexStreams(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, uint32_t vertexStreamMask);
 
+	// all streams live in one buffer, one view per VertexFormat::VERTEXSTREAM
 	MSWRL::ComPtr<ID3D12Resource> _vertexBuffer;
-	D3D12_VERTEX_BUFFER_VIEW _vertexBufferView = {};
+	D3D12_VERTEX_BUFFER_VIEW _vertexBufferViews[VertexFormat::STREAM_COUNT] = {};
 	uint32_t _vertexCount = 0;
 
 	MSWRL::ComPtr<ID3D12Resource> _indexBuffer;
 	D3D12_INDEX_BUFFER_VIEW _indexBufferView = {};
+	DXGI_FORMAT _indexFormat = DXGI_FORMAT_R32_UINT;
 	uint32_t _indexCount = 0;
 
 	int32_t _materialIndex = NOTOK;
 	AABB _aabb;
+	XMFLOAT3 _boundsCenter = { 0, 0, 0 };
+	float _boundsRadius = 0.0f;
+	std::vector<MeshProcessing::LodLevel> _lods;
+	std::vector<MeshProcessing::Meshlet> _meshlets;
 };
\ No newline at end of file
@@ -43,11 +43,14 @@ void Renderer::InitializeResources()
 
 	CreateConstantBuffers();
 
+	TextureCache::InitializeTextureCache();
+
 	//_modelManager.LoadModel("../assets/helmet.glb");
 	//_modelManager.LoadModel("../assets/helmets.glb");
 	//_modelManager.LoadModel("../assets/sponza.glb");
-	_modelManager.LoadModel("../assets/brick_wall.glb");
-	_modelManager.LoadModel("../assets/DamagedHelmet.glb");
+	// one upload batch and one fence for the whole level
+	const std::filesystem::path levelModels[] = { "../assets/brick_wall.glb", "../assets/DamagedHelmet.glb" };
+	_modelManager.LoadModels(levelModels);
 	//_modelManager.LoadModel("../assets/apollo.glb");
 	//_modelManager.LoadModel("../assets/bistro.glb");
 }
@@ -265,6 +268,8 @@ void Renderer::CreateConstantBuffers()
 
 void Renderer::Render(float dt)
 {
+	// models finished in the background join the frame here
+	_modelManager.Update();
 	UpdateBuffers(dt);
 	SetCommandlist();
 	GUI::SetViewportTextureHandle(_viewportSRV_GPU);
@@ -386,7 +391,13 @@ void Renderer::SetCommandlist()
 				_mainLoopGraphicsContext.GetCommandList()->SetGraphicsRootDescriptorTable(slot.value(), DescriptorAllocator::CBVSRVUAV::GetGPUHandle(_dLight->_dLightLVPCPUHandle));
 		}
 
-		_modelManager.DrawAll(*_mainPass, _mainLoopGraphicsContext);
+		// meshlet culling and lod selection against the camera, the depth pass renders from the light and draws everything
+		MeshProcessing::CullingCamera cullingCamera;
+		cullingCamera.viewProjection = _viewProjectionMatrix;
+		XMStoreFloat3(&cullingCamera.position, _camera->_position);
+		cullingCamera.projectionScale = _projectionMatrix._22 * static_cast<float>(GUI::viewportHeight) * 0.5f;
+
+		_modelManager.DrawAll(*_mainPass, _mainLoopGraphicsContext, _meshletCulling ? &cullingCamera : nullptr);
 	}
 
 	if (_bbPass->_usePass)
@@ -418,5 +429,7 @@ void Renderer::SetCommandlist()
 
 void Renderer::Shutdown()
 {
+	_modelManager.WaitForLoads();
+	//_modelManager.WriteImportReport("../import_report.json");
 	CommandQueueManager::GetCommandQueue(QUEUETYPE::QUEUE_GRAPHICS).WaitForFence();
 }
@@ -8,6 +8,7 @@
 #include "Shader.h"
 #include "ShaderPass.h"
 #include "ModelManager.h"
+#include "TextureCache.h"
 #include "Camera.h"
 #include "DirectionalLight.h"
 #include "PointLight.h"
@@ -64,4 +65,5 @@ public:
 	std::shared_ptr<Camera> _camera;
 
 	ModelManager _modelManager;
+	bool _meshletCulling = true;
 };
\ No newline at end of file
@@ -59,4 +59,19 @@ Shader::Shader(const std::filesystem::path& path, SHADERTYPE shaderType)
 	}
 
 	ThrowIfFailed(_compiledShaderBuffer->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&_shaderBlob), nullptr), "Failed to retrieve Shader Blob!");
+}
+
+MSWRL::ComPtr<ID3D12ShaderReflection> Shader::CreateReflection() const
+{
+	MSWRL::ComPtr<IDxcBlob> reflectionBlob{};
+	ThrowIfFailed(_compiledShaderBuffer->GetOutput(DXC_OUT_REFLECTION, IID_PPV_ARGS(&reflectionBlob), nullptr), "Failed to retrieve Shader Reflection Data!");
+
+	DxcBuffer reflectionBuffer{};
+	reflectionBuffer.Ptr = reflectionBlob->GetBufferPointer();
+	reflectionBuffer.Size = reflectionBlob->GetBufferSize();
+	reflectionBuffer.Encoding = 0;
+
+	MSWRL::ComPtr<ID3D12ShaderReflection> shaderReflection{};
+	ThrowIfFailed(D3D12Core::ShaderCompiler::utils->CreateReflection(&reflectionBuffer, IID_PPV_ARGS(&shaderReflection)), "Failed to create Shader Reflection!");
+	return shaderReflection;
 }
\ No newline at end of file
@@ -18,6 +18,8 @@ public:
 	Shader() = default;
 	Shader(const std::filesystem::path&, SHADERTYPE shaderType);
 
+	MSWRL::ComPtr<ID3D12ShaderReflection> CreateReflection() const;
+
 	SHADERTYPE _shaderType = SHADER_INVALID;
 	MSWRL::ComPtr<IDxcResult> _compiledShaderBuffer;
 	MSWRL::ComPtr<IDxcBlob> _shaderBlob;
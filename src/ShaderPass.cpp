@@ -18,16 +18,7 @@ void ShaderPass::GenerateGraphicsRootSignature()
 	uint32_t incrementor = 0;
 	for (const auto& shader : _shaders)
 	{
-		MSWRL::ComPtr<IDxcBlob> reflectionBlob{};
-		ThrowIfFailed(shader.second._compiledShaderBuffer->GetOutput(DXC_OUT_REFLECTION, IID_PPV_ARGS(&reflectionBlob), nullptr), "Failed to retrieve Shader Reflection Data!");
-
-		DxcBuffer reflectionBuffer{};
-		reflectionBuffer.Ptr = reflectionBlob->GetBufferPointer();
-		reflectionBuffer.Size = reflectionBlob->GetBufferSize();
-		reflectionBuffer.Encoding = 0;
-
-		MSWRL::ComPtr<ID3D12ShaderReflection> shaderReflection{};
-		D3D12Core::ShaderCompiler::utils->CreateReflection(&reflectionBuffer, IID_PPV_ARGS(&shaderReflection));
+		MSWRL::ComPtr<ID3D12ShaderReflection> shaderReflection = shader.second.CreateReflection();
 		D3D12_SHADER_DESC shaderDesc{};
 		shaderReflection->GetDesc(&shaderDesc);
 
@@ -124,16 +115,10 @@ void ShaderPass::GenerateGraphicsRootSignature()
 
 void ShaderPass::GeneratePipeLineStateObjectForwardPass(D3D12_FILL_MODE fillMode, D3D12_CULL_MODE cullMode, bool alphaBlending)
 {
-	D3D12_INPUT_ELEMENT_DESC inputElementDescs[] = {
-		{"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0,D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 24, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"TANGENT", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 32, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-		{"BITANGENT", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 48, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0},
-	};
+	GenerateInputLayout();
 
 	D3D12_GRAPHICS_PIPELINE_STATE_DESC psoDesc = {};
-	psoDesc.InputLayout = { inputElementDescs, _countof(inputElementDescs) };
+	psoDesc.InputLayout = { _inputElements.data(), static_cast<uint32_t>(_inputElements.size()) };
 	psoDesc.pRootSignature = _rootSignature.Get();
 
 	D3D12_SHADER_BYTECODE vsBytecode;
@@ -185,6 +170,38 @@ void ShaderPass::GeneratePipeLineStateObjectForwardPass(D3D12_FILL_MODE fillMode
 	ThrowIfFailed(D3D12Core::GraphicsDevice::device->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&_pipelineState)), "PipelineStateObject creation failed!");
 }
 
+void ShaderPass::GenerateInputLayout()
+{
+	_inputElements.clear();
+	_vertexStreamMask = 0;
+
+	auto vertexShader = _shaders.find(SHADERTYPE::SHADER_VERTEX);
+	if (vertexShader == _shaders.end())
+		ThrowException("ShaderPass " + _name + " has no vertex shader");
+
+	MSWRL::ComPtr<ID3D12ShaderReflection> shaderReflection = vertexShader->second.CreateReflection();
+	D3D12_SHADER_DESC shaderDesc{};
+	shaderReflection->GetDesc(&shaderDesc);
+
+	for (uint32_t i = 0; i < shaderDesc.InputParameters; i++)
+	{
+		D3D12_SIGNATURE_PARAMETER_DESC parameterDesc{};
+		shaderReflection->GetInputParameterDesc(i, &parameterDesc);
+
+		// SV_VertexID and friends are generated, not fetched
+		if (parameterDesc.SystemValueType != D3D_NAME_UNDEFINED)
+			continue;
+
+		// element descs point at the static semantic names of VertexFormat, not into the reflection
+		std::optional<D3D12_INPUT_ELEMENT_DESC> element = VertexFormat::FindInputElement(parameterDesc.SemanticName, parameterDesc.SemanticIndex);
+		if (!element)
+			ThrowException("ShaderPass " + _name + ": no vertex stream provides " + parameterDesc.SemanticName + std::to_string(parameterDesc.SemanticIndex));
+
+		_inputElements.push_back(*element);
+		_vertexStreamMask |= 1u << element->InputSlot;
+	}
+}
+
 std::optional<uint32_t> ShaderPass::GetRootParameterIndex(const std::string& name) const {
 	auto it = _bindingMap.find(name);
 	if (it == _bindingMap.end())
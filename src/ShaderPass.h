@@ -7,6 +7,7 @@
 #include "GUI.h"
 #include "IGUIComponent.h"
 #include "Shader.h"
+#include "VertexFormat.h"
 
 class ShaderPass : public IGUIComponent
 {
@@ -19,6 +20,9 @@ public:
 	void GenerateGraphicsRootSignature();
 	void GeneratePipeLineStateObjectForwardPass(D3D12_FILL_MODE fillMode, D3D12_CULL_MODE cullMode, bool alphaBlending);
 
+	// input layout from the reflected input signature of the vertex shader, called by the pipeline state generation
+	void GenerateInputLayout();
+
 	std::optional<uint32_t> GetRootParameterIndex(const std::string& name) const;
 
 	void DrawGUI();
@@ -29,6 +33,9 @@ public:
 	std::unordered_map<std::string, uint32_t> _bindingMap;
 	std::unordered_map<SHADERTYPE, Shader> _shaders;
 
+	std::vector<D3D12_INPUT_ELEMENT_DESC> _inputElements;
+	uint32_t _vertexStreamMask = 0; // bit per VertexFormat::VERTEXSTREAM the vertex shader reads
+
 	std::string _name;
 
 	bool _usePass = true;
@@ -1,33 +1,25 @@
 #include "Texture.h"
 
-Texture::Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, ScratchImage& scratchImage)
+Texture::Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, const ScratchImage& scratchImage)
 {
-	_image = std::move(scratchImage);
+	// expects the full mip chain, see TextureProcessing::GenerateMipChain
+	_textureType = texType;
 
-	// dont generate mipmaps for fallbacktextures -> throws error
-	if (_image.GetMetadata().width > 1 && _image.GetMetadata().height > 1)
-	{
-		ScratchImage mipChain;
-		ThrowIfFailed(GenerateMipMaps(
-			_image.GetImages(),
-			_image.GetImageCount(),
-			_image.GetMetadata(),
-			TEX_FILTER_DEFAULT,
-			0,
-			mipChain
-		));
-
-		_image = std::move(mipChain);
-	}
+	CreateBuffers(commandList, scratchImage.GetMetadata(), scratchImage.GetImages(), scratchImage.GetImageCount());
+}
 
+Texture::Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, const TexMetadata& metadata, const Image* images, size_t imageCount)
+{
 	_textureType = texType;
 
-	CreateBuffers(commandList);
+	CreateBuffers(commandList, metadata, images, imageCount);
 }
 
-void Texture::CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
+void Texture::CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, const TexMetadata& metadata, const Image* images, size_t imageCount)
 {
-	const TexMetadata& metadata = _image.GetMetadata();
+	if (imageCount < metadata.mipLevels)
+		ThrowException("texture has less images than mip levels");
+
 	_mipCount = static_cast<uint32_t>(metadata.mipLevels);
 
 	D3D12_RESOURCE_DESC textureDesc = {};
@@ -69,13 +61,14 @@ void Texture::CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList
 	std::vector<D3D12_SUBRESOURCE_DATA> subresources(_mipCount);
 
 	for (size_t i = 0; i < _mipCount; ++i) {
-		const Image* img = _image.GetImage(i, 0, 0);
+		const Image* img = &images[i];
 		subresources[i].pData = img->pixels;
 		subresources[i].RowPitch = img->rowPitch;
 		subresources[i].SlicePitch = img->slicePitch;
 	}
 
 	UpdateSubresources(commandList.Get(), _textureResource.Get(), _textureUploadHeap.Get(), 0, 0, _mipCount, subresources.data());
+	_uploadRecordingId = CommandContext::GetRecordingId(commandList.Get());
 
 	_srvCpuHandle = DescriptorAllocator::CBVSRVUAV::Allocate();
 
@@ -89,6 +82,26 @@ void Texture::CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList
 	D3D12Core::GraphicsDevice::device->CreateShaderResourceView(_textureResource.Get(), &srvDesc, _srvCpuHandle);
 }
 
+void Texture::ReleaseUploadHeap()
+{
+	_textureUploadHeap.Reset();
+}
+
+void Texture::RetainImage(ScratchImage&& scratchImage)
+{
+	_image = std::move(scratchImage);
+}
+
+uint64_t Texture::GetUploadHeapBytes() const
+{
+	return _textureUploadHeap ? _textureUploadHeap->GetDesc().Width : 0;
+}
+
+uint64_t Texture::GetStagingBytes() const
+{
+	return GetUploadHeapBytes() + _image.GetPixelsSize();
+}
+
 void Texture::BindTexture(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList)
 {
 	D3D12_GPU_DESCRIPTOR_HANDLE gpuHandle = DescriptorAllocator::CBVSRVUAV::GetGPUHandle(_srvCpuHandle);
@@ -98,8 +111,8 @@ void Texture::BindTexture(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12Grap
 		if (auto slot = shaderPass.GetRootParameterIndex("albedoTexture"))
 			commandList->SetGraphicsRootDescriptorTable(slot.value(), gpuHandle);
 		break;
-	case TEXTURE_METALLICROUGHNESS:
-		if (auto slot = shaderPass.GetRootParameterIndex("metallicRoughnessTexture"))
+	case TEXTURE_ORM:
+		if (auto slot = shaderPass.GetRootParameterIndex("ormTexture"))
 			commandList->SetGraphicsRootDescriptorTable(slot.value(), gpuHandle);
 		break;
 	case TEXTURE_NORMAL:
@@ -110,10 +123,6 @@ void Texture::BindTexture(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12Grap
 		if (auto slot = shaderPass.GetRootParameterIndex("emissiveTexture"))
 			commandList->SetGraphicsRootDescriptorTable(slot.value(), gpuHandle);
 		break;
-	case TEXTURE_OCCLUSION:
-		if (auto slot = shaderPass.GetRootParameterIndex("occlusionTexture"))
-			commandList->SetGraphicsRootDescriptorTable(slot.value(), gpuHandle);
-		break;
 	default:
 		break;
 	}
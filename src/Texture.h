@@ -2,6 +2,7 @@
 
 #include "pch.h"
 
+#include <atomic>
 #include <wincodec.h>
 
 #include "DirectXTex.h"
@@ -17,19 +18,38 @@ public:
 	enum TEXTURETYPE
 	{
 		TEXTURE_ALBEDO = 0,
-		TEXTURE_METALLICROUGHNESS = 1,
+		TEXTURE_ORM = 1, // R occlusion, G roughness, B metallic: the glTF metallicRoughness layout with occlusion packed into R
 		TEXTURE_NORMAL = 2,
-		TEXTURE_EMISSIVE = 3,
-		TEXTURE_OCCLUSION = 4
+		TEXTURE_EMISSIVE = 3
 	};
+	static constexpr size_t TEXTURETYPE_COUNT = 4;
 
 public:
 	Texture() = default;
-	Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, ScratchImage& scratchImage);
+	// the pixels are copied into the upload heap while recording, the caller can release the image right after
+	Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, const ScratchImage& scratchImage);
+	// uploads from memory owned by someone else (e.g. a mapped cache entry), only read while recording
+	Texture(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, Texture::TEXTURETYPE texType, const TexMetadata& metadata, const Image* images, size_t imageCount);
 	void BindTexture(const ShaderPass& shaderPass, MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
+	// only once _uploadFenceValue completed, the copy out of the upload heap has to have run
+	void ReleaseUploadHeap();
+	// keeps the source pixels for the lifetime of the texture, only with GLTFLoader::releaseStagingCopies off
+	void RetainImage(ScratchImage&& scratchImage);
+	uint64_t GetUploadHeapBytes() const;
+	// CPU visible memory besides the GPU copy: the upload heap until it is released and a retained image
+	uint64_t GetStagingBytes() const;
+
+	// upload queue fence value after which the texture is resident. Textures are shared through the TextureCache
+	// before their upload was submitted, so the load that recorded it (_uploadRecordingId, see CommandContext) publishes
+	// the value later
+	static constexpr uint64_t UPLOAD_PENDING = UINT64_MAX;
+	// the recording was never submitted (see TextureCache::EvictPendingUploads), the texture will not become resident
+	static constexpr uint64_t UPLOAD_FAILED = UINT64_MAX - 1;
+	std::atomic<uint64_t> _uploadFenceValue = UPLOAD_PENDING;
+	uint64_t _uploadRecordingId = 0;
 
 private:
-	void CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList);
+	void CreateBuffers(MSWRL::ComPtr<ID3D12GraphicsCommandList> commandList, const TexMetadata& metadata, const Image* images, size_t imageCount);
 
 	MSWRL::ComPtr<ID3D12Resource> _textureUploadHeap;
 	MSWRL::ComPtr<ID3D12Resource> _textureResource; 
@@ -0,0 +1,135 @@
+#include "TextureCache.h"
+
+#include "GLTFLoader.h"
+
+namespace TextureCache
+{
+	std::shared_ptr<Texture> fallbackTextures[Texture::TEXTURETYPE_COUNT];
+	std::unordered_map<uint64_t, std::weak_ptr<Texture>> textures;
+	std::unordered_map<uint64_t, std::vector<std::shared_ptr<Texture>>> recordedUploads;
+	std::vector<SubmittedUpload> submittedUploads;
+	std::mutex cacheMutex;
+
+	void InitializeTextureCache()
+	{
+		// fallbacks get their own upload so every model can reference them without depending on another model's upload
+		CommandContext uploadContext;
+		uploadContext.InitializeCommandContext(QUEUETYPE::QUEUE_UPLOAD);
+
+		const Texture::TEXTURETYPE texTypes[] = {
+			Texture::TEXTURETYPE::TEXTURE_ALBEDO,
+			Texture::TEXTURETYPE::TEXTURE_ORM,
+			Texture::TEXTURETYPE::TEXTURE_NORMAL,
+			Texture::TEXTURETYPE::TEXTURE_EMISSIVE
+		};
+
+		for (Texture::TEXTURETYPE texType : texTypes)
+		{
+			ScratchImage scratchImage = GLTFLoader::LoadFallbackTexture(texType);
+			TextureCache::fallbackTextures[texType] = std::make_shared<Texture>(uploadContext.GetCommandList(), texType, scratchImage);
+		}
+
+		uint64_t fenceValue = uploadContext.Finish(true);
+		for (const std::shared_ptr<Texture>& texture : TextureCache::fallbackTextures)
+			texture->_uploadFenceValue = fenceValue;
+	}
+
+	std::shared_ptr<Texture> GetFallbackTexture(Texture::TEXTURETYPE texType)
+	{
+		if (!TextureCache::fallbackTextures[texType])
+			ThrowException("TextureCache used before InitializeTextureCache");
+
+		return TextureCache::fallbackTextures[texType];
+	}
+
+	std::shared_ptr<Texture> Find(uint64_t contentHash, Texture::TEXTURETYPE texType)
+	{
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+
+		auto it = TextureCache::textures.find(MakeKey(contentHash, texType));
+		if (it == TextureCache::textures.end())
+			return nullptr;
+
+		std::shared_ptr<Texture> texture = it->second.lock();
+		if (!texture)
+			TextureCache::textures.erase(it);
+
+		return texture;
+	}
+
+	std::shared_ptr<Texture> Insert(uint64_t contentHash, Texture::TEXTURETYPE texType, std::shared_ptr<Texture> texture)
+	{
+		// a concurrent load may have won the entry, the texture that lost still has its copy in this recording
+		TrackUpload(texture);
+
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+
+		std::weak_ptr<Texture>& entry = TextureCache::textures[MakeKey(contentHash, texType)];
+		if (std::shared_ptr<Texture> existing = entry.lock())
+			return existing;
+
+		entry = texture;
+		return texture;
+	}
+
+	void TrackUpload(std::shared_ptr<Texture> texture)
+	{
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+		TextureCache::recordedUploads[texture->_uploadRecordingId].push_back(std::move(texture));
+	}
+
+	void PublishUploadFence(uint64_t recordingId, uint64_t fenceValue, std::shared_ptr<CommandContext> uploadContext)
+	{
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+
+		SubmittedUpload& upload = TextureCache::submittedUploads.emplace_back();
+		upload.fenceValue = fenceValue;
+		upload.uploadContext = std::move(uploadContext);
+
+		auto it = TextureCache::recordedUploads.find(recordingId);
+		if (it == TextureCache::recordedUploads.end())
+			return;
+
+		for (const std::shared_ptr<Texture>& texture : it->second)
+			if (texture->_uploadFenceValue == Texture::UPLOAD_PENDING)
+				texture->_uploadFenceValue = fenceValue;
+
+		upload.textures = std::move(it->second);
+		TextureCache::recordedUploads.erase(it);
+	}
+
+	void EvictPendingUploads(uint64_t recordingId)
+	{
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+
+		std::erase_if(TextureCache::textures, [recordingId](const auto& entry)
+		{
+			std::shared_ptr<Texture> texture = entry.second.lock();
+			return texture && texture->_uploadRecordingId == recordingId && texture->_uploadFenceValue == Texture::UPLOAD_PENDING;
+		});
+
+		// never executed, nothing reads from them anymore
+		auto it = TextureCache::recordedUploads.find(recordingId);
+		if (it == TextureCache::recordedUploads.end())
+			return;
+
+		for (const std::shared_ptr<Texture>& texture : it->second)
+			if (texture->_uploadFenceValue == Texture::UPLOAD_PENDING)
+				texture->_uploadFenceValue = Texture::UPLOAD_FAILED;
+
+		TextureCache::recordedUploads.erase(it);
+	}
+
+	void ReleaseCompletedUploads()
+	{
+		CommandQueue& uploadQueue = CommandQueueManager::GetCommandQueue(QUEUETYPE::QUEUE_UPLOAD);
+
+		std::lock_guard<std::mutex> lock(TextureCache::cacheMutex);
+		std::erase_if(TextureCache::submittedUploads, [&uploadQueue](const SubmittedUpload& upload) { return uploadQueue.IsFenceComplete(upload.fenceValue); });
+	}
+
+	uint64_t MakeKey(uint64_t contentHash, Texture::TEXTURETYPE texType)
+	{
+		return contentHash ^ ((static_cast<uint64_t>(texType) + 1) * 0x9E3779B97F4A7C15ull);
+	}
+}
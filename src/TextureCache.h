@@ -0,0 +1,52 @@
+#pragma once
+
+#include "pch.h"
+
+#include <mutex>
+
+#include "Texture.h"
+#include "CommandContext.h"
+
+namespace TextureCache
+{
+	void InitializeTextureCache();
+
+	std::shared_ptr<Texture> GetFallbackTexture(Texture::TEXTURETYPE texType);
+
+	// textures are keyed by the hash of their encoded image bytes and their type, so the same image used in
+	// another role (e.g. albedo vs emissive) still gets its own Texture
+	std::shared_ptr<Texture> Find(uint64_t contentHash, Texture::TEXTURETYPE texType);
+	// returns the texture another load inserted first if there is one. The texture passed in is tracked either way, its
+	// copy is already recorded
+	std::shared_ptr<Texture> Insert(uint64_t contentHash, Texture::TEXTURETYPE texType, std::shared_ptr<Texture> texture);
+
+	// holds a texture recorded into an upload until the recording is submitted and its fence completed, so the copy
+	// never reads from a texture its load already dropped
+	void TrackUpload(std::shared_ptr<Texture> texture);
+	// hands the fence value of a submitted upload recording to every texture recorded into it,
+	// other loads that found those textures wait on it before they publish. The context is held with the textures, a
+	// load that failed while recording drops its own references before the copies ran
+	void PublishUploadFence(uint64_t recordingId, uint64_t fenceValue, std::shared_ptr<CommandContext> uploadContext);
+	// drops the textures of a recording that will never be submitted and marks them UPLOAD_FAILED, later loads decode
+	// them again and loads that already took them fail
+	void EvictPendingUploads(uint64_t recordingId);
+	// render thread: lets go of the tracked textures and contexts whose upload completed
+	void ReleaseCompletedUploads();
+
+	// a submitted upload recording, held until its fence completed
+	struct SubmittedUpload
+	{
+		uint64_t fenceValue = 0;
+		std::shared_ptr<CommandContext> uploadContext;
+		std::vector<std::shared_ptr<Texture>> textures;
+	};
+
+	uint64_t MakeKey(uint64_t contentHash, Texture::TEXTURETYPE texType);
+
+	extern std::shared_ptr<Texture> fallbackTextures[Texture::TEXTURETYPE_COUNT];
+	extern std::unordered_map<uint64_t, std::weak_ptr<Texture>> textures;
+	// by recording id until the recording is submitted
+	extern std::unordered_map<uint64_t, std::vector<std::shared_ptr<Texture>>> recordedUploads;
+	extern std::vector<SubmittedUpload> submittedUploads;
+	extern std::mutex cacheMutex;
+}
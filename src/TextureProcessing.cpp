@@ -0,0 +1,942 @@
+#include "TextureProcessing.h"
+
+#include <array>
+#include <mutex>
+#include <DirectXPackedVector.h>
+#include <basisu_transcoder.h>
+
+#include "ImageDecoder.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <immintrin.h>
+// the build stays at the SSE2 baseline, AVX2 kernels are compiled for their own functions and picked at runtime.
+// MSVC compiles AVX2 intrinsics in any function
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "JobSystem.h"
+
+namespace TextureProcessing
+{
+	bool transcodeBasisu = true;
+	bool compressTextures = true;
+	bool bc7Quick = true;
+	uint32_t compressionBandRows = 64;
+	bool useMipGenerator = true;
+	uint32_t mipBandRows = 32;
+	bool useAVX2 = true;
+
+	struct TranscodeTarget
+	{
+		basist::transcoder_texture_format basisFormat = basist::transcoder_texture_format::cTFRGBA32;
+		DXGI_FORMAT dxgiFormat = DXGI_FORMAT_R8G8B8A8_UNORM;
+		int32_t channel0 = -1; // source channels of the two BC5 channels, -1 keeps the transcoder default
+		int32_t channel1 = -1;
+	};
+
+	TranscodeTarget SelectTranscodeTarget(Texture::TEXTURETYPE texType, basist::basis_tex_format sourceFormat, bool hasAlpha)
+	{
+		TranscodeTarget target;
+
+		if (texType == Texture::TEXTURETYPE::TEXTURE_NORMAL)
+		{
+			// the shader rebuilds z. ETC1S normal maps (toktx --normal_mode) keep y in the alpha slice
+			target.basisFormat = basist::transcoder_texture_format::cTFBC5_RG;
+			target.dxgiFormat = DXGI_FORMAT_BC5_UNORM;
+			target.channel0 = 0;
+			target.channel1 = sourceFormat == basist::basis_tex_format::cETC1S && hasAlpha ? 3 : 1;
+		}
+		else if (basist::basis_is_format_supported(basist::transcoder_texture_format::cTFBC7_RGBA, sourceFormat))
+		{
+			target.basisFormat = basist::transcoder_texture_format::cTFBC7_RGBA;
+			target.dxgiFormat = DXGI_FORMAT_BC7_UNORM;
+		}
+		else if (hasAlpha)
+		{
+			target.basisFormat = basist::transcoder_texture_format::cTFBC3_RGBA;
+			target.dxgiFormat = DXGI_FORMAT_BC3_UNORM;
+		}
+		else
+		{
+			target.basisFormat = basist::transcoder_texture_format::cTFBC1_RGB;
+			target.dxgiFormat = DXGI_FORMAT_BC1_UNORM;
+		}
+
+		return target;
+	}
+
+	bool IsKTX2(std::span<const uint8_t> bytes)
+	{
+		static constexpr uint8_t identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+		return bytes.size() >= sizeof(identifier) && memcmp(bytes.data(), identifier, sizeof(identifier)) == 0;
+	}
+
+	ScratchImage TranscodeKTX2(std::span<const uint8_t> bytes, Texture::TEXTURETYPE texType)
+	{
+		static std::once_flag transcoderInitialized;
+		std::call_once(transcoderInitialized, []() { basist::basisu_transcoder_init(); });
+
+		basist::ktx2_transcoder transcoder;
+		if (!transcoder.init(bytes.data(), static_cast<uint32_t>(bytes.size())) || !transcoder.start_transcoding())
+			ThrowException("invalid KTX2 image");
+
+		uint32_t width = transcoder.get_width();
+		uint32_t height = transcoder.get_height();
+		uint32_t levelCount = std::max(transcoder.get_levels(), 1u);
+
+		// a single level needs mips generated, which works on pixels only. D3D12 wants block compressed top levels in whole blocks
+		bool blockCompressed = levelCount > 1 && width % 4 == 0 && height % 4 == 0;
+		TranscodeTarget target = blockCompressed ? SelectTranscodeTarget(texType, transcoder.get_format(), transcoder.get_has_alpha()) : TranscodeTarget();
+
+		ScratchImage scratchImage;
+		ThrowIfFailed(scratchImage.Initialize2D(target.dxgiFormat, width, height, 1, levelCount));
+
+		// first layer and face only, glTF textures are plain 2D
+		basist::ktx2_transcoder_state state;
+		for (uint32_t level = 0; level < levelCount; ++level)
+		{
+			const Image* image = scratchImage.GetImage(level, 0, 0);
+			uint32_t outputSize = blockCompressed
+				? static_cast<uint32_t>(((image->width + 3) / 4) * ((image->height + 3) / 4))
+				: static_cast<uint32_t>(image->width * image->height);
+
+			if (!transcoder.transcode_image_level(level, 0, 0, image->pixels, outputSize, target.basisFormat, 0, 0, 0, target.channel0, target.channel1, &state))
+				ThrowException("KTX2 transcoding failed");
+		}
+
+		return scratchImage;
+	}
+	ScratchImage DecodeImage(std::span<const uint8_t> bytes)
+	{
+		std::string error;
+		ImageDecoder::ImageInfo info;
+		if (!ImageDecoder::ReadInfo(bytes, info, &error))
+			ThrowException(error);
+
+		// sized from the header, the decoder writes straight into the image
+		ScratchImage scratchImage;
+		ThrowIfFailed(scratchImage.Initialize2D(info.sixteenBit ? DXGI_FORMAT_R16G16B16A16_UNORM : DXGI_FORMAT_R8G8B8A8_UNORM, info.width, info.height, 1, 1));
+
+		const Image& image = *scratchImage.GetImage(0, 0, 0);
+		if (!ImageDecoder::Decode(bytes, info, image.pixels, image.rowPitch, &error))
+			ThrowException(error);
+
+		return scratchImage;
+	}
+
+	void ApplyColorSpace(ScratchImage& scratchImage, Texture::TEXTURETYPE texType)
+	{
+		if (texType != Texture::TEXTURETYPE::TEXTURE_ALBEDO && texType != Texture::TEXTURETYPE::TEXTURE_EMISSIVE)
+			return;
+
+		DXGI_FORMAT format = scratchImage.GetMetadata().format;
+		if (IsSRGB(format))
+			return;
+
+		// formats without an sRGB variant (16 bit PNGs) go to 8 bit first, the values are sRGB encoded already
+		DXGI_FORMAT srgbFormat = MakeSRGB(format);
+		if (srgbFormat == format)
+		{
+			ScratchImage converted;
+			ThrowIfFailed(Convert(scratchImage.GetImages(), scratchImage.GetImageCount(), scratchImage.GetMetadata(), DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, converted));
+			scratchImage = std::move(converted);
+			srgbFormat = DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+		}
+
+		if (!scratchImage.OverrideFormat(srgbFormat))
+			ThrowException("could not tag texture as sRGB");
+	}
+
+	ScratchImage PackORM(const ScratchImage* metallicRoughness, const ScratchImage* occlusion)
+	{
+		// top levels only, mips are generated from the packed image
+		auto toRGBA8 = [](const ScratchImage* source)
+		{
+			ScratchImage result;
+			if (!source)
+				return result;
+
+			const Image& top = *source->GetImage(0, 0, 0);
+			if (IsCompressed(top.format))
+				ThrowIfFailed(Decompress(top, DXGI_FORMAT_R8G8B8A8_UNORM, result));
+			else if (top.format != DXGI_FORMAT_R8G8B8A8_UNORM)
+				ThrowIfFailed(Convert(top, DXGI_FORMAT_R8G8B8A8_UNORM, TEX_FILTER_DEFAULT, TEX_THRESHOLD_DEFAULT, result));
+			else
+				ThrowIfFailed(result.InitializeFromImage(top));
+			return result;
+		};
+
+		ScratchImage metallicRoughnessRGBA = toRGBA8(metallicRoughness);
+		ScratchImage occlusionRGBA = toRGBA8(occlusion);
+
+		const Image* reference = metallicRoughness ? metallicRoughnessRGBA.GetImage(0, 0, 0) : occlusion ? occlusionRGBA.GetImage(0, 0, 0) : nullptr;
+		if (!reference)
+			ThrowException("ORM packing without source image");
+
+		const size_t width = reference->width;
+		const size_t height = reference->height;
+		if (metallicRoughness && occlusion && (occlusionRGBA.GetMetadata().width != width || occlusionRGBA.GetMetadata().height != height))
+		{
+			ScratchImage resized;
+			ThrowIfFailed(Resize(*occlusionRGBA.GetImage(0, 0, 0), width, height, TEX_FILTER_DEFAULT, resized));
+			occlusionRGBA = std::move(resized);
+		}
+
+		ScratchImage packed;
+		ThrowIfFailed(packed.Initialize2D(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1));
+
+		const Image& destination = *packed.GetImage(0, 0, 0);
+		const Image* metallicRoughnessImage = metallicRoughness ? metallicRoughnessRGBA.GetImage(0, 0, 0) : nullptr;
+		const Image* occlusionImage = occlusion ? occlusionRGBA.GetImage(0, 0, 0) : nullptr;
+		for (size_t y = 0; y < height; ++y)
+		{
+			uint8_t* row = destination.pixels + y * destination.rowPitch;
+			const uint8_t* metallicRoughnessRow = metallicRoughnessImage ? metallicRoughnessImage->pixels + y * metallicRoughnessImage->rowPitch : nullptr;
+			const uint8_t* occlusionRow = occlusionImage ? occlusionImage->pixels + y * occlusionImage->rowPitch : nullptr;
+			for (size_t x = 0; x < width; ++x)
+			{
+				row[x * 4 + 0] = occlusionRow ? occlusionRow[x * 4] : 255;
+				row[x * 4 + 1] = metallicRoughnessRow ? metallicRoughnessRow[x * 4 + 1] : 255;
+				row[x * 4 + 2] = metallicRoughnessRow ? metallicRoughnessRow[x * 4 + 2] : 255;
+				row[x * 4 + 3] = 255;
+			}
+		}
+
+		return packed;
+	}
+
+	// sRGB <-> linear for the 8 bit kernels: decoding is exact per code value, encoding is indexed with 16 bit linear
+	// values, which stays far below half a code value of error even in the steep dark range of the curve
+	struct SRGBTables
+	{
+		float toLinear[256];
+		uint8_t fromLinear[65536 + 3]; // the AVX2 kernel gathers 4 bytes at every index
+	};
+
+	const SRGBTables& GetSRGBTables()
+	{
+		static const std::unique_ptr<SRGBTables> tables = []()
+		{
+			auto result = std::make_unique<SRGBTables>();
+			for (uint32_t i = 0; i < 256; ++i)
+			{
+				float srgb = i / 255.0f;
+				result->toLinear[i] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+			}
+			for (uint32_t i = 0; i < 65536; ++i)
+			{
+				float linear = i / 65535.0f;
+				float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+				result->fromLinear[i] = static_cast<uint8_t>(std::clamp(srgb * 255.0f + 0.5f, 0.0f, 255.0f));
+			}
+			result->fromLinear[65536] = result->fromLinear[65537] = result->fromLinear[65538] = 0;
+			return result;
+		}();
+		return *tables;
+	}
+
+	// one destination row of 4 byte texels from the two source rows under it. Destination texel x is the box of source
+	// texels 2x and 2x + 1 and a source width of 1 repeats its only texel. Levels with an odd source side go through
+	// DownsampleLevelWeighted instead
+	using DownsampleRowFunction = void (*)(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth);
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	bool HasAVX2()
+	{
+		static const bool hasAVX2 = []()
+		{
+#if defined(_MSC_VER)
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7)
+				return false;
+
+			// the OS has to save the ymm registers as well (OSXSAVE, AVX, XCR0 bits 1 and 2)
+			__cpuid(info, 1);
+			if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0 || (_xgetbv(0) & 0x6) != 0x6)
+				return false;
+
+			__cpuidex(info, 7, 0);
+			return (info[1] & (1 << 5)) != 0;
+#else
+			return __builtin_cpu_supports("avx2") != 0;
+#endif
+		}();
+		return hasAVX2 && TextureProcessing::useAVX2;
+	}
+
+	// rounded average of the two texel pairs of top/bottom (4 texels each), 4 16 bit channels per result texel
+	inline __m128i AverageTexelPairs(__m128i top, __m128i bottom)
+	{
+		const __m128i zero = _mm_setzero_si128();
+		__m128i low = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+		__m128i high = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+		low = _mm_add_epi16(low, _mm_srli_si128(low, 8));
+		high = _mm_add_epi16(high, _mm_srli_si128(high, 8));
+		return _mm_srli_epi16(_mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_set1_epi16(2)), 2);
+	}
+
+	// 4 destination texels per iteration from x on, returns where it stopped
+	size_t DownsampleTexelsSSE2(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t x, size_t width)
+	{
+		for (; x + 4 <= width; x += 4)
+		{
+			const uint8_t* top = row0 + x * 8;
+			const uint8_t* bottom = row1 + x * 8;
+			__m128i first = AverageTexelPairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom)));
+			__m128i second = AverageTexelPairs(_mm_loadu_si128(reinterpret_cast<const __m128i*>(top + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + 16)));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_packus_epi16(first, second));
+		}
+		return x;
+	}
+#endif
+
+	// texel by texel from x on: the tail of the vector loops and sources of width 1
+	void DownsampleTexelsUnorm(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t x, size_t width, size_t sourceWidth)
+	{
+		const size_t step = sourceWidth > 1 ? 4 : 0;
+		for (; x < width; ++x)
+		{
+			const uint8_t* top = row0 + x * 8;
+			const uint8_t* bottom = row1 + x * 8;
+			for (size_t channel = 0; channel < 4; ++channel)
+				destination[x * 4 + channel] = static_cast<uint8_t>((top[channel] + top[channel + step] + bottom[channel] + bottom[channel + step] + 2) >> 2);
+		}
+	}
+
+	// every channel averaged as stored: linear color, ORM, alpha
+	void DownsampleRowUnorm(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth)
+	{
+		size_t x = 0;
+		if (sourceWidth > 1)
+		{
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+			x = DownsampleTexelsSSE2(row0, row1, destination, x, width);
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+			// deinterleaved channels: pairwise add across the top row, accumulate the bottom row, rounding narrow by 4
+			for (; x + 8 <= width; x += 8)
+			{
+				uint8x16x4_t top = vld4q_u8(row0 + x * 8);
+				uint8x16x4_t bottom = vld4q_u8(row1 + x * 8);
+				uint8x8x4_t result;
+				result.val[0] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[0]), bottom.val[0]), 2);
+				result.val[1] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[1]), bottom.val[1]), 2);
+				result.val[2] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[2]), bottom.val[2]), 2);
+				result.val[3] = vrshrn_n_u16(vpadalq_u8(vpaddlq_u8(top.val[3]), bottom.val[3]), 2);
+				vst4_u8(destination + x * 4, result);
+			}
+#endif
+		}
+
+		DownsampleTexelsUnorm(row0, row1, destination, x, width, sourceWidth);
+	}
+
+	// color averaged in linear space (the two texels of a column first, the same order as the AVX2 kernel so both
+	// round alike), alpha as stored
+	void DownsampleTexelsSRGB(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t x, size_t width, size_t sourceWidth)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+		const size_t step = sourceWidth > 1 ? 4 : 0;
+		for (; x < width; ++x)
+		{
+			const uint8_t* top = row0 + x * 8;
+			const uint8_t* bottom = row1 + x * 8;
+			for (size_t channel = 0; channel < 3; ++channel)
+			{
+				float linear = ((tables.toLinear[top[channel]] + tables.toLinear[bottom[channel]]) + (tables.toLinear[top[channel + step]] + tables.toLinear[bottom[channel + step]])) * 0.25f;
+				destination[x * 4 + channel] = tables.fromLinear[static_cast<uint32_t>(linear * 65535.0f + 0.5f)];
+			}
+			destination[x * 4 + 3] = static_cast<uint8_t>((top[3] + top[3 + step] + bottom[3] + bottom[3 + step] + 2) >> 2);
+		}
+	}
+
+	// the table lookups are the work here. Without gathers (SSE2, NEON) they stay scalar, vectorizing only the adds around them gains nothing
+	void DownsampleRowSRGB(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth)
+	{
+		DownsampleTexelsSRGB(row0, row1, destination, 0, width, sourceWidth);
+	}
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+	// same per 128 bit lane, texels 0-3 and 4-7 of top/bottom
+	TARGET_AVX2 inline __m256i AverageTexelPairsAVX2(__m256i top, __m256i bottom)
+	{
+		const __m256i zero = _mm256_setzero_si256();
+		__m256i low = _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+		__m256i high = _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+		low = _mm256_add_epi16(low, _mm256_srli_si256(low, 8));
+		high = _mm256_add_epi16(high, _mm256_srli_si256(high, 8));
+		return _mm256_srli_epi16(_mm256_add_epi16(_mm256_unpacklo_epi64(low, high), _mm256_set1_epi16(2)), 2);
+	}
+
+	TARGET_AVX2 void DownsampleRowUnormAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth)
+	{
+		size_t x = 0;
+		if (sourceWidth > 1)
+		{
+			for (; x + 8 <= width; x += 8)
+			{
+				const uint8_t* top = row0 + x * 8;
+				const uint8_t* bottom = row1 + x * 8;
+				__m256i first = AverageTexelPairsAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(top)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom)));
+				__m256i second = AverageTexelPairsAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(top + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bottom + 32)));
+				// packing works per lane, which interleaves the texel pairs of both halves
+				__m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), _MM_SHUFFLE(3, 1, 2, 0));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + x * 4), packed);
+			}
+			x = DownsampleTexelsSSE2(row0, row1, destination, x, width);
+		}
+
+		DownsampleTexelsUnorm(row0, row1, destination, x, width, sourceWidth);
+	}
+
+	// two RGBA8 texels, one 32 bit lane per channel
+	TARGET_AVX2 inline __m256i LoadTexelPairAVX2(const uint8_t* texels)
+	{
+		return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(texels)));
+	}
+
+	// 2 destination texels per iteration, both table lookups become gathers
+	TARGET_AVX2 void DownsampleRowSRGBAVX2(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+		size_t x = 0;
+		if (sourceWidth > 1)
+		{
+			const __m256 quarter = _mm256_set1_ps(0.25f);
+			const __m256 indexScale = _mm256_set1_ps(65535.0f);
+			const __m256 half = _mm256_set1_ps(0.5f);
+			const __m256i byteMask = _mm256_set1_epi32(0xFF);
+			const __m256i two = _mm256_set1_epi32(2);
+
+			for (; x + 2 <= width; x += 2)
+			{
+				// the texel pair under destination x (0) and x + 1 (1) of both rows
+				__m256i top0 = LoadTexelPairAVX2(row0 + x * 8);
+				__m256i top1 = LoadTexelPairAVX2(row0 + x * 8 + 8);
+				__m256i bottom0 = LoadTexelPairAVX2(row1 + x * 8);
+				__m256i bottom1 = LoadTexelPairAVX2(row1 + x * 8 + 8);
+
+				// per column, then [left columns | right columns] of both destination texels added up
+				__m256 columns0 = _mm256_add_ps(_mm256_i32gather_ps(tables.toLinear, top0, 4), _mm256_i32gather_ps(tables.toLinear, bottom0, 4));
+				__m256 columns1 = _mm256_add_ps(_mm256_i32gather_ps(tables.toLinear, top1, 4), _mm256_i32gather_ps(tables.toLinear, bottom1, 4));
+				__m256 linear = _mm256_add_ps(_mm256_permute2f128_ps(columns0, columns1, 0x20), _mm256_permute2f128_ps(columns0, columns1, 0x31));
+				linear = _mm256_mul_ps(linear, quarter);
+
+				__m256i index = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(linear, indexScale), half));
+				__m256i color = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(tables.fromLinear), index, 1), byteMask);
+
+				__m256i sums0 = _mm256_add_epi32(top0, bottom0);
+				__m256i sums1 = _mm256_add_epi32(top1, bottom1);
+				__m256i alpha = _mm256_add_epi32(_mm256_permute2x128_si256(sums0, sums1, 0x20), _mm256_permute2x128_si256(sums0, sums1, 0x31));
+				alpha = _mm256_srli_epi32(_mm256_add_epi32(alpha, two), 2);
+
+				// channel 3 of both texels from alpha, then down to bytes: texel x ends up in lane 0, texel x + 1 in lane 4
+				__m256i texels = _mm256_blend_epi32(color, alpha, 0x88);
+				texels = _mm256_packus_epi32(texels, texels);
+				texels = _mm256_packus_epi16(texels, texels);
+				uint32_t first = static_cast<uint32_t>(_mm256_cvtsi256_si32(texels));
+				uint32_t second = static_cast<uint32_t>(_mm256_extract_epi32(texels, 4));
+				memcpy(destination + x * 4, &first, sizeof(first));
+				memcpy(destination + x * 4 + 4, &second, sizeof(second));
+			}
+		}
+
+		DownsampleTexelsSRGB(row0, row1, destination, x, width, sourceWidth);
+	}
+#endif
+
+	inline XMVECTOR LoadTexel(const uint8_t* texel)
+	{
+		PackedVector::XMUBYTEN4 packed = {};
+		memcpy(&packed, texel, sizeof(packed));
+		return PackedVector::XMLoadUByteN4(&packed);
+	}
+
+	// xyz averaged as unit vectors and renormalized, so the box does not shorten the normals of bumpy areas.
+	// The length is invariant under channel order, which makes BGRA work the same
+	void DownsampleRowNormal(const uint8_t* row0, const uint8_t* row1, uint8_t* destination, size_t width, size_t sourceWidth)
+	{
+		const size_t step = sourceWidth > 1 ? 4 : 0;
+		for (size_t x = 0; x < width; ++x)
+		{
+			const uint8_t* top = row0 + x * 8;
+			const uint8_t* bottom = row1 + x * 8;
+			XMVECTOR sum = XMVectorAdd(XMVectorAdd(LoadTexel(top), LoadTexel(top + step)), XMVectorAdd(LoadTexel(bottom), LoadTexel(bottom + step)));
+
+			// mean of the [-1, 1] decoded texels: sum / 4 * 2 - 1
+			XMVECTOR normal = XMVectorSubtract(XMVectorScale(sum, 0.5f), XMVectorSplatOne());
+			XMVECTOR lengthSq = XMVector3LengthSq(normal);
+			if (XMVectorGetX(lengthSq) > 1e-8f)
+				normal = XMVectorMultiply(normal, XMVectorReciprocalSqrt(lengthSq));
+
+			XMVECTOR encoded = XMVectorMultiplyAdd(normal, XMVectorReplicate(0.5f), XMVectorReplicate(0.5f));
+			encoded = XMVectorSetW(encoded, XMVectorGetW(sum) * 0.25f);
+
+			PackedVector::XMUBYTEN4 packed;
+			PackedVector::XMStoreUByteN4(&packed, encoded);
+			memcpy(destination + x * 4, &packed, sizeof(packed));
+		}
+	}
+
+	DownsampleRowFunction SelectDownsampleRow(DXGI_FORMAT format, Texture::TEXTURETYPE texType)
+	{
+		switch (format)
+		{
+		case DXGI_FORMAT_R8G8B8A8_UNORM:
+		case DXGI_FORMAT_B8G8R8A8_UNORM:
+			if (texType == Texture::TEXTURETYPE::TEXTURE_NORMAL)
+				return DownsampleRowNormal;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+			if (HasAVX2())
+				return DownsampleRowUnormAVX2;
+#endif
+			return DownsampleRowUnorm;
+		case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+		case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+			if (HasAVX2())
+				return DownsampleRowSRGBAVX2;
+#endif
+			return DownsampleRowSRGB;
+		default:
+			return nullptr;
+		}
+	}
+
+	// fn(firstRow, rowCount) for bands of mipBandRows rows on the worker pool
+	void ForEachRowBand(size_t height, const std::function<void(size_t, size_t)>& fn)
+	{
+		const size_t bandRows = std::max<size_t>(1, TextureProcessing::mipBandRows);
+		JobSystem::ParallelFor((height + bandRows - 1) / bandRows, [&](size_t band)
+		{
+			size_t firstRow = band * bandRows;
+			fn(firstRow, std::min(bandRows, height - firstRow));
+		});
+	}
+
+	// source texels under destination texel x along one side
+	struct FilterTaps
+	{
+		size_t first = 0;
+		uint32_t count = 0;
+		float weights[3] = {};
+	};
+
+	// an odd side 2n + 1 shrinks to n: destination texel x covers source texels [x * (2n + 1) / n, (x + 1) * (2n + 1) / n),
+	// which are 3 texels weighted (n - x, n, x + 1) / (2n + 1), so the edge texels are kept (NVIDIA, "Non-Power-of-Two
+	// Mipmapping"). Even sides reduce to the box
+	FilterTaps GetFilterTaps(size_t x, size_t sourceSize)
+	{
+		FilterTaps taps;
+		taps.first = 2 * x;
+		if (sourceSize == 1)
+		{
+			taps.first = 0;
+			taps.count = 1;
+			taps.weights[0] = 1.0f;
+		}
+		else if (sourceSize % 2 == 0)
+		{
+			taps.count = 2;
+			taps.weights[0] = 0.5f;
+			taps.weights[1] = 0.5f;
+		}
+		else
+		{
+			const size_t half = sourceSize / 2;
+			const float size = static_cast<float>(sourceSize);
+			taps.count = 3;
+			taps.weights[0] = static_cast<float>(half - x) / size;
+			taps.weights[1] = static_cast<float>(half) / size;
+			taps.weights[2] = static_cast<float>(x + 1) / size;
+		}
+		return taps;
+	}
+
+	// levels whose source has an odd side (non power of two textures), texel by texel in float with the same color
+	// handling as the row kernels: sRGB averaged in linear space, normals renormalized, alpha as stored
+	void DownsampleLevelWeighted(const Image& previous, const Image& current, bool srgb, bool normal)
+	{
+		const SRGBTables& tables = GetSRGBTables();
+		auto encode = [](float value) { return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+
+		ForEachRowBand(current.height, [&](size_t firstRow, size_t rowCount)
+		{
+			for (size_t y = firstRow; y < firstRow + rowCount; ++y)
+			{
+				const FilterTaps rowTaps = GetFilterTaps(y, previous.height);
+				uint8_t* destination = current.pixels + y * current.rowPitch;
+				for (size_t x = 0; x < current.width; ++x)
+				{
+					const FilterTaps columnTaps = GetFilterTaps(x, previous.width);
+
+					float sum[4] = {};
+					for (uint32_t row = 0; row < rowTaps.count; ++row)
+					{
+						const uint8_t* sourceRow = previous.pixels + (rowTaps.first + row) * previous.rowPitch;
+						for (uint32_t column = 0; column < columnTaps.count; ++column)
+						{
+							const uint8_t* texel = sourceRow + (columnTaps.first + column) * 4;
+							const float weight = rowTaps.weights[row] * columnTaps.weights[column];
+							for (size_t channel = 0; channel < 3; ++channel)
+								sum[channel] += weight * (srgb ? tables.toLinear[texel[channel]] : texel[channel] * (1.0f / 255.0f));
+							sum[3] += weight * texel[3] * (1.0f / 255.0f);
+						}
+					}
+
+					if (normal)
+					{
+						// mean of the [-1, 1] decoded texels, back to [0, 1] once it is unit length again
+						XMVECTOR mean = XMVectorSubtract(XMVectorScale(XMVectorSet(sum[0], sum[1], sum[2], 0.0f), 2.0f), XMVectorSplatOne());
+						XMVECTOR lengthSq = XMVector3LengthSq(mean);
+						if (XMVectorGetX(lengthSq) > 1e-8f)
+							mean = XMVectorMultiply(mean, XMVectorReciprocalSqrt(lengthSq));
+
+						XMFLOAT3 encoded;
+						XMStoreFloat3(&encoded, XMVectorMultiplyAdd(mean, XMVectorReplicate(0.5f), XMVectorReplicate(0.5f)));
+						sum[0] = encoded.x;
+						sum[1] = encoded.y;
+						sum[2] = encoded.z;
+					}
+
+					uint8_t* result = destination + x * 4;
+					for (size_t channel = 0; channel < 3; ++channel)
+						result[channel] = srgb ? tables.fromLinear[static_cast<uint32_t>(std::clamp(sum[channel], 0.0f, 1.0f) * 65535.0f + 0.5f)] : encode(sum[channel]);
+					result[3] = encode(sum[3]);
+				}
+			}
+		});
+	}
+
+	std::array<uint64_t, 256> GetAlphaHistogram(const Image& image)
+	{
+		std::mutex histogramMutex;
+		std::array<uint64_t, 256> histogram = {};
+		ForEachRowBand(image.height, [&](size_t firstRow, size_t rowCount)
+		{
+			std::array<uint64_t, 256> bandHistogram = {};
+			for (size_t y = firstRow; y < firstRow + rowCount; ++y)
+			{
+				const uint8_t* row = image.pixels + y * image.rowPitch;
+				for (size_t x = 0; x < image.width; ++x)
+					++bandHistogram[row[x * 4 + 3]];
+			}
+
+			std::lock_guard<std::mutex> lock(histogramMutex);
+			for (size_t i = 0; i < histogram.size(); ++i)
+				histogram[i] += bandHistogram[i];
+		});
+		return histogram;
+	}
+
+	// fraction of texels that pass the alpha test (alpha >= threshold)
+	double GetAlphaCoverage(const std::array<uint64_t, 256>& histogram, uint8_t alphaThreshold)
+	{
+		uint64_t passing = std::accumulate(histogram.begin() + alphaThreshold, histogram.end(), uint64_t(0));
+		uint64_t total = std::accumulate(histogram.begin(), histogram.end(), uint64_t(0));
+		return total ? static_cast<double>(passing) / total : 0.0;
+	}
+
+	// scales alpha so the same fraction of texels passes the alpha test as on the top level, otherwise averaging
+	// thins out masked geometry like foliage with every level (Castano, "Computing Alpha Mipmaps")
+	void PreserveAlphaCoverage(const Image& image, double coverage, uint8_t alphaThreshold)
+	{
+		std::array<uint64_t, 256> histogram = GetAlphaHistogram(image);
+
+		// highest alpha that lets at least as many texels pass as the top level would, it gets mapped to the threshold
+		const uint64_t targetTexels = static_cast<uint64_t>(std::llround(coverage * image.width * image.height));
+		uint32_t alpha = 256;
+		uint64_t passing = 0;
+		while (alpha > 1 && passing < targetTexels)
+			passing += histogram[--alpha];
+
+		if (targetTexels == 0 || alpha == alphaThreshold)
+			return;
+
+		uint8_t remap[256];
+		for (uint32_t i = 0; i < 256; ++i)
+			remap[i] = static_cast<uint8_t>(std::min<uint32_t>(255, i * alphaThreshold / alpha));
+
+		ForEachRowBand(image.height, [&](size_t firstRow, size_t rowCount)
+		{
+			for (size_t y = firstRow; y < firstRow + rowCount; ++y)
+			{
+				uint8_t* row = image.pixels + y * image.rowPitch;
+				for (size_t x = 0; x < image.width; ++x)
+					row[x * 4 + 3] = remap[row[x * 4 + 3]];
+			}
+		});
+	}
+
+	// formats without a kernel, sRGB ones still filtered in linear space
+	void GenerateMipChainDirectXTex(ScratchImage& scratchImage)
+	{
+		TEX_FILTER_FLAGS filter = IsSRGB(scratchImage.GetMetadata().format) ? TEX_FILTER_SRGB : TEX_FILTER_DEFAULT;
+
+		ScratchImage mipChain;
+		ThrowIfFailed(GenerateMipMaps(scratchImage.GetImages(), scratchImage.GetImageCount(), scratchImage.GetMetadata(), filter, 0, mipChain));
+		scratchImage = std::move(mipChain);
+	}
+
+	void GenerateMipChain(ScratchImage& scratchImage, Texture::TEXTURETYPE texType, float alphaCutoff)
+	{
+		// transcoded KTX2 images bring their own mips (as blocks)
+		const TexMetadata metadata = scratchImage.GetMetadata();
+		if (metadata.mipLevels != 1 || metadata.arraySize != 1 || metadata.dimension != TEX_DIMENSION_TEXTURE2D || IsCompressed(metadata.format))
+			return;
+
+		// the chain ends at 1x1, so 1x1 fallbacks have nothing to generate
+		size_t levelCount = 1;
+		while ((std::max(metadata.width, metadata.height) >> levelCount) > 0)
+			++levelCount;
+		if (levelCount == 1)
+			return;
+
+		DownsampleRowFunction downsampleRow = SelectDownsampleRow(metadata.format, texType);
+		if (!TextureProcessing::useMipGenerator || !downsampleRow)
+		{
+			GenerateMipChainDirectXTex(scratchImage);
+			return;
+		}
+
+		ScratchImage mipChain;
+		ThrowIfFailed(mipChain.Initialize2D(metadata.format, metadata.width, metadata.height, 1, levelCount));
+
+		const Image& source = *scratchImage.GetImage(0, 0, 0);
+		const Image& top = *mipChain.GetImage(0, 0, 0);
+		for (size_t y = 0; y < top.height; ++y)
+			memcpy(top.pixels + y * top.rowPitch, source.pixels + y * source.rowPitch, top.width * 4);
+
+		const bool preserveCoverage = alphaCutoff > 0.0f;
+		const uint8_t alphaThreshold = static_cast<uint8_t>(std::clamp(std::ceil(alphaCutoff * 255.0f), 1.0f, 255.0f));
+		const double coverage = preserveCoverage ? GetAlphaCoverage(GetAlphaHistogram(top), alphaThreshold) : 0.0;
+
+		// same split as SelectDownsampleRow
+		const bool srgb = IsSRGB(metadata.format);
+		const bool normal = texType == Texture::TEXTURETYPE::TEXTURE_NORMAL && !srgb;
+
+		// every level is filtered from the previous one, its rows in parallel
+		for (size_t level = 1; level < levelCount; ++level)
+		{
+			const Image& previous = *mipChain.GetImage(level - 1, 0, 0);
+			const Image& current = *mipChain.GetImage(level, 0, 0);
+
+			const bool oddSource = (previous.width > 1 && previous.width % 2 != 0) || (previous.height > 1 && previous.height % 2 != 0);
+			if (oddSource)
+			{
+				DownsampleLevelWeighted(previous, current, srgb, normal);
+			}
+			else
+			{
+				ForEachRowBand(current.height, [&](size_t firstRow, size_t rowCount)
+				{
+					for (size_t y = firstRow; y < firstRow + rowCount; ++y)
+					{
+						const uint8_t* row0 = previous.pixels + std::min(2 * y, previous.height - 1) * previous.rowPitch;
+						const uint8_t* row1 = previous.pixels + std::min(2 * y + 1, previous.height - 1) * previous.rowPitch;
+						downsampleRow(row0, row1, current.pixels + y * current.rowPitch, current.width, previous.width);
+					}
+				});
+			}
+
+			if (preserveCoverage)
+				PreserveAlphaCoverage(current, coverage, alphaThreshold);
+		}
+
+		scratchImage = std::move(mipChain);
+	}
+
+	void BenchmarkMipGeneration(uint32_t size, uint32_t repeatCount)
+	{
+		// albedo with one texel black/white stripes (188 averaged in linear space, 128 in gamma space) and a foliage
+		// like mask in alpha, a bumpy normal map and a noisy ORM texture
+		struct BenchmarkCase
+		{
+			const char* name;
+			Texture::TEXTURETYPE texType;
+			DXGI_FORMAT format;
+			float alphaCutoff;
+			ScratchImage image;
+		};
+
+		BenchmarkCase cases[] =
+		{
+			{ "albedo (masked)", Texture::TEXTURETYPE::TEXTURE_ALBEDO, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, 0.5f },
+			{ "normal", Texture::TEXTURETYPE::TEXTURE_NORMAL, DXGI_FORMAT_R8G8B8A8_UNORM, 0.0f },
+			{ "orm", Texture::TEXTURETYPE::TEXTURE_ORM, DXGI_FORMAT_R8G8B8A8_UNORM, 0.0f },
+		};
+
+		for (BenchmarkCase& benchmarkCase : cases)
+		{
+			ThrowIfFailed(benchmarkCase.image.Initialize2D(benchmarkCase.format, size, size, 1, 1));
+			const Image& image = *benchmarkCase.image.GetImage(0, 0, 0);
+
+			uint32_t noise = 0x12345678u;
+			for (size_t y = 0; y < size; ++y)
+			{
+				uint8_t* row = image.pixels + y * image.rowPitch;
+				for (size_t x = 0; x < size; ++x)
+				{
+					noise = noise * 1664525u + 1013904223u;
+					float fx = static_cast<float>(x) / size;
+					float fy = static_cast<float>(y) / size;
+					uint8_t* texel = row + x * 4;
+
+					if (benchmarkCase.texType == Texture::TEXTURETYPE::TEXTURE_ALBEDO)
+					{
+						uint8_t stripe = static_cast<uint8_t>((x & 1) ? 255 : 0);
+						bool leaf = std::sin(fx * 300.0f) * std::sin(fy * 300.0f) > 0.6f;
+						texel[0] = stripe;
+						texel[1] = stripe;
+						texel[2] = stripe;
+						texel[3] = static_cast<uint8_t>(leaf ? 255 : 0);
+					}
+					else if (benchmarkCase.texType == Texture::TEXTURETYPE::TEXTURE_NORMAL)
+					{
+						XMVECTOR normal = XMVector3Normalize(XMVectorSet(std::cos(fx * 400.0f), std::sin(fy * 400.0f), 1.0f, 0.0f));
+						XMVECTOR encoded = XMVectorSetW(XMVectorMultiplyAdd(normal, XMVectorReplicate(0.5f), XMVectorReplicate(0.5f)), 1.0f);
+						PackedVector::XMUBYTEN4 packed;
+						PackedVector::XMStoreUByteN4(&packed, encoded);
+						memcpy(texel, &packed, sizeof(packed));
+					}
+					else
+					{
+						memcpy(texel, &noise, sizeof(noise));
+					}
+				}
+			}
+		}
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+		const char* kernels = HasAVX2() ? "AVX2" : "SSE2";
+#elif defined(_M_ARM64) || defined(__ARM_NEON)
+		const char* kernels = "NEON";
+#else
+		const char* kernels = "scalar";
+#endif
+		PRINT("Mip generation benchmark: ", size, "x", size, " RGBA8, ", repeatCount, " runs, ", JobSystem::GetWorkerCount(), " workers, ", kernels, " kernels");
+
+		for (BenchmarkCase& benchmarkCase : cases)
+		{
+			ScratchImage reference;
+			double referenceMs = 0.0;
+			double generatorMs = 0.0;
+			for (uint32_t run = 0; run < repeatCount; ++run)
+			{
+				// what the loader did before: DirectXTex with the default filter, in gamma space
+				Utils::Timer::StartTimer();
+				ThrowIfFailed(GenerateMipMaps(*benchmarkCase.image.GetImage(0, 0, 0), TEX_FILTER_DEFAULT, 0, reference));
+				referenceMs += Utils::Timer::GetElapsedMilliseconds();
+			}
+
+			ScratchImage generated;
+			for (uint32_t run = 0; run < repeatCount; ++run)
+			{
+				ThrowIfFailed(generated.InitializeFromImage(*benchmarkCase.image.GetImage(0, 0, 0)));
+				Utils::Timer::StartTimer();
+				GenerateMipChain(generated, benchmarkCase.texType, benchmarkCase.alphaCutoff);
+				generatorMs += Utils::Timer::GetElapsedMilliseconds();
+			}
+
+			referenceMs /= std::max(repeatCount, 1u);
+			generatorMs /= std::max(repeatCount, 1u);
+			PRINT("  ", benchmarkCase.name, ": DirectXTex ", referenceMs, "ms | generator ", generatorMs, "ms (", referenceMs / std::max(generatorMs, 0.001), "x)");
+
+			if (benchmarkCase.texType == Texture::TEXTURETYPE::TEXTURE_ALBEDO)
+			{
+				const uint8_t alphaThreshold = 128;
+				const size_t level = std::min<size_t>(4, generated.GetMetadata().mipLevels - 1);
+				PRINT("    level 1 stripe value: DirectXTex ", static_cast<uint32_t>(reference.GetImage(1, 0, 0)->pixels[0]), " | generator ", static_cast<uint32_t>(generated.GetImage(1, 0, 0)->pixels[0]), " (188 is the linear space average)");
+				PRINT("    alpha coverage at level ", level, ": top ", GetAlphaCoverage(GetAlphaHistogram(*generated.GetImage(0, 0, 0)), alphaThreshold),
+					" | DirectXTex ", GetAlphaCoverage(GetAlphaHistogram(*reference.GetImage(level, 0, 0)), alphaThreshold),
+					" | generator ", GetAlphaCoverage(GetAlphaHistogram(*generated.GetImage(level, 0, 0)), alphaThreshold));
+			}
+		}
+
+		// all textures of the set at once, the way the loader runs them
+		std::vector<ScratchImage> images(std::size(cases));
+		for (size_t i = 0; i < images.size(); ++i)
+			ThrowIfFailed(images[i].InitializeFromImage(*cases[i].image.GetImage(0, 0, 0)));
+
+		Utils::Timer::StartTimer();
+		JobSystem::ParallelFor(images.size(), [&](size_t i) { GenerateMipChain(images[i], cases[i].texType, cases[i].alphaCutoff); });
+		PRINT("  all ", images.size(), " textures in parallel: ", Utils::Timer::GetElapsedMilliseconds(), "ms");
+	}
+
+	DXGI_FORMAT GetCompressedFormat(Texture::TEXTURETYPE texType)
+	{
+		switch (texType)
+		{
+		case Texture::TEXTURETYPE::TEXTURE_NORMAL:
+			return DXGI_FORMAT_BC5_UNORM;
+		default:
+			return DXGI_FORMAT_BC7_UNORM;
+		}
+	}
+
+	void CompressTexture(ScratchImage& scratchImage, Texture::TEXTURETYPE texType)
+	{
+		const TexMetadata& metadata = scratchImage.GetMetadata();
+		if (IsCompressed(metadata.format) || metadata.width % 4 != 0 || metadata.height % 4 != 0)
+			return;
+
+		DXGI_FORMAT format = GetCompressedFormat(texType);
+		if (IsSRGB(metadata.format))
+			format = MakeSRGB(format);
+
+		ScratchImage compressed;
+		ThrowIfFailed(compressed.Initialize2D(format, metadata.width, metadata.height, 1, metadata.mipLevels));
+
+		// bands of whole block rows, so every band lands at a block row of the destination
+		struct Band
+		{
+			size_t mip = 0;
+			size_t firstRow = 0;
+			size_t rowCount = 0;
+		};
+
+		size_t bandRows = std::max<size_t>(4, TextureProcessing::compressionBandRows / 4 * 4);
+		std::vector<Band> bands;
+		for (size_t mip = 0; mip < metadata.mipLevels; ++mip)
+		{
+			size_t height = scratchImage.GetImage(mip, 0, 0)->height;
+			for (size_t row = 0; row < height; row += bandRows)
+				bands.push_back({ mip, row, std::min(bandRows, height - row) });
+		}
+
+		TEX_COMPRESS_FLAGS flags = TextureProcessing::bc7Quick ? TEX_COMPRESS_BC7_QUICK : TEX_COMPRESS_DEFAULT;
+
+		JobSystem::ParallelFor(bands.size(), [&](size_t bandIndex)
+		{
+			const Band& band = bands[bandIndex];
+			const Image& mip = *scratchImage.GetImage(band.mip, 0, 0);
+
+			Image source = mip;
+			source.height = band.rowCount;
+			source.pixels = mip.pixels + band.firstRow * mip.rowPitch;
+			source.slicePitch = mip.rowPitch * band.rowCount;
+
+			ScratchImage blocks;
+			ThrowIfFailed(Compress(source, format, flags, TEX_THRESHOLD_DEFAULT, blocks));
+
+			const Image& destination = *compressed.GetImage(band.mip, 0, 0);
+			memcpy(destination.pixels + (band.firstRow / 4) * destination.rowPitch, blocks.GetPixels(), blocks.GetPixelsSize());
+		});
+
+		scratchImage = std::move(compressed);
+	}
+
+	uint64_t GetSettingsHash()
+	{
+		// 1: albedo/emissive are tagged sRGB, 2: sRGB mips are filtered in linear space
+		const uint32_t settings[] = { 2, TextureProcessing::compressTextures, TextureProcessing::bc7Quick, TextureProcessing::useMipGenerator };
+		return Utils::HashBytes(settings, sizeof(settings));
+	}
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "pch.h"
+
+#include "Texture.h"
+
+// CPU side texture passes that run on decoded or encoded images, before anything touches the GPU
+namespace TextureProcessing
+{
+	// KTX2 identifier, the first 12 bytes of every KTX2 file
+	bool IsKTX2(std::span<const uint8_t> bytes);
+
+	// KHR_texture_basisu: transcodes every level of the KTX2 file straight to a block format picked by the texture role,
+	// BC5 for normals (xy only), BC7 for the rest (BC3/BC1 where the source format has no BC7 path).
+	// Files with a single level or dimensions that are no multiple of 4 are transcoded to RGBA8 so mips can be generated
+	ScratchImage TranscodeKTX2(std::span<const uint8_t> bytes, Texture::TEXTURETYPE texType);
+
+	// PNG/JPEG through ImageDecoder (stb_image, SSE2/NEON IDCT and color conversion for JPEG) straight into the
+	// ScratchImage, without WIC. RGBA8, RGBA16 for 16 bit PNGs
+	ScratchImage DecodeImage(std::span<const uint8_t> bytes);
+
+	// R from the occlusion image, G/B from the metallic/roughness image, either may be null (its channels become 1).
+	// Single level RGBA8 at the metallic/roughness size, occlusion is resized when it differs
+	ScratchImage PackORM(const ScratchImage* metallicRoughness, const ScratchImage* occlusion);
+
+	// box filtered chain down to 1x1 for uncompressed single level images, anything else is left as is. RGBA8/BGRA8 run on
+	// the SSE2/NEON kernels, or AVX2 when the CPU has it and useAVX2 is set: sRGB images are filtered in linear space and
+	// normal maps renormalized. Levels below an odd side use a 3 tap weighted filter that keeps the edge texels.
+	// With an alphaCutoff the alpha of every level is scaled so as many texels pass the cutoff as on the top level.
+	// Other formats go through DirectXTex. The rows of every level are filtered in bands of mipBandRows in parallel
+	void GenerateMipChain(ScratchImage& scratchImage, Texture::TEXTURETYPE texType, float alphaCutoff = 0.0f);
+
+	// synthetic albedo (masked)/normal/ORM textures, compared against DirectXTex GenerateMipMaps as the loader used it
+	void BenchmarkMipGeneration(uint32_t size, uint32_t repeatCount);
+
+	// glTF albedo and emissive are sRGB encoded, the tagged format lets the sampler return linear values
+	void ApplyColorSpace(ScratchImage& scratchImage, Texture::TEXTURETYPE texType);
+
+	// BC7 for albedo, emissive and ORM, BC5 for normals (the shader rebuilds z).
+	// sRGB sources get the sRGB variant. Every mip is split into bands of compressionBandRows rows that are encoded in
+	// parallel, images whose top level is no whole number of blocks stay uncompressed
+	void CompressTexture(ScratchImage& scratchImage, Texture::TEXTURETYPE texType);
+	DXGI_FORMAT GetCompressedFormat(Texture::TEXTURETYPE texType);
+
+	// seeds the content hash of every texture, so differently processed results never share a cache entry
+	uint64_t GetSettingsHash();
+
+	extern bool transcodeBasisu;
+	extern bool compressTextures;
+	extern bool bc7Quick;
+	extern uint32_t compressionBandRows;
+	extern bool useMipGenerator;
+	extern uint32_t mipBandRows;
+	extern bool useAVX2;
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "pch.h"
+
+#include <array>
+#include <cctype>
+#include <optional>
+#include <DirectXPackedVector.h>
+
+// GPU vertex formats, described once at compile time: the packing from the CPU side Vertex
+// and the D3D12 input layout are both generated from the same attribute list.
+namespace VertexFormat
+{
+	inline int16_t ToSnorm16(float value)
+	{
+		return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+	}
+
+	// octahedral mapping of a unit vector onto [-1, 1]^2
+	inline XMFLOAT2 EncodeOctahedral(const XMFLOAT3& direction)
+	{
+		float length = std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z);
+		if (length < 1e-20f)
+			return { 0.0f, 0.0f };
+
+		float x = direction.x / length;
+		float y = direction.y / length;
+
+		if (direction.z < 0.0f)
+		{
+			float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+			float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+			x = foldedX;
+			y = foldedY;
+		}
+
+		return { x, y };
+	}
+
+	// Attributes: Storage is what ends up in the vertex buffer, it has to be a multiple of 4 bytes
+	struct PositionFloat3
+	{
+		using Storage = XMFLOAT3;
+		static constexpr const char* semantic = "POSITION";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+
+		static void Pack(const Vertex& vertex, Storage& storage) { storage = vertex.position; }
+	};
+
+	struct NormalFloat3
+	{
+		using Storage = XMFLOAT3;
+		static constexpr const char* semantic = "NORMAL";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32_FLOAT;
+
+		static void Pack(const Vertex& vertex, Storage& storage) { storage = vertex.normal; }
+	};
+
+	struct NormalOctahedral
+	{
+		using Storage = std::array<int16_t, 2>;
+		static constexpr const char* semantic = "NORMAL";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16_SNORM;
+
+		static void Pack(const Vertex& vertex, Storage& storage)
+		{
+			XMFLOAT2 octahedral = EncodeOctahedral(vertex.normal);
+			storage = { ToSnorm16(octahedral.x), ToSnorm16(octahedral.y) };
+		}
+	};
+
+	struct TexCoordFloat2
+	{
+		using Storage = XMFLOAT2;
+		static constexpr const char* semantic = "TEXCOORD";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32_FLOAT;
+
+		static void Pack(const Vertex& vertex, Storage& storage) { storage = vertex.uv; }
+	};
+
+	struct TexCoordHalf2
+	{
+		using Storage = std::array<uint16_t, 2>;
+		static constexpr const char* semantic = "TEXCOORD";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16_FLOAT;
+
+		static void Pack(const Vertex& vertex, Storage& storage)
+		{
+			storage = { PackedVector::XMConvertFloatToHalf(vertex.uv.x), PackedVector::XMConvertFloatToHalf(vertex.uv.y) };
+		}
+	};
+
+	struct TangentFloat4
+	{
+		using Storage = XMFLOAT4;
+		static constexpr const char* semantic = "TANGENT";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R32G32B32A32_FLOAT;
+
+		static void Pack(const Vertex& vertex, Storage& storage) { storage = vertex.tangent; }
+	};
+
+	// xy octahedral direction, z handedness, w unused
+	struct TangentOctahedral
+	{
+		using Storage = std::array<int16_t, 4>;
+		static constexpr const char* semantic = "TANGENT";
+		static constexpr DXGI_FORMAT format = DXGI_FORMAT_R16G16B16A16_SNORM;
+
+		static void Pack(const Vertex& vertex, Storage& storage)
+		{
+			XMFLOAT2 octahedral = EncodeOctahedral({ vertex.tangent.x, vertex.tangent.y, vertex.tangent.z });
+			storage = { ToSnorm16(octahedral.x), ToSnorm16(octahedral.y), ToSnorm16(vertex.tangent.w < 0.0f ? -1.0f : 1.0f), 0 };
+		}
+	};
+
+	template<typename... Attributes>
+	struct Layout
+	{
+		static constexpr size_t attributeCount = sizeof...(Attributes);
+
+		static_assert(((sizeof(typename Attributes::Storage) % 4 == 0) && ...), "vertex attributes have to be 4 byte aligned");
+
+		static constexpr uint32_t stride = (static_cast<uint32_t>(sizeof(typename Attributes::Storage)) + ...);
+
+		static constexpr std::array<uint32_t, attributeCount> offsets = []()
+		{
+			constexpr uint32_t sizes[] = { static_cast<uint32_t>(sizeof(typename Attributes::Storage))... };
+
+			std::array<uint32_t, attributeCount> result = {};
+			uint32_t offset = 0;
+			for (size_t i = 0; i < attributeCount; ++i)
+			{
+				result[i] = offset;
+				offset += sizes[i];
+			}
+			return result;
+		}();
+
+		static std::array<D3D12_INPUT_ELEMENT_DESC, attributeCount> GetInputElements(uint32_t inputSlot = 0)
+		{
+			std::array<D3D12_INPUT_ELEMENT_DESC, attributeCount> elements = {};
+			size_t i = 0;
+			((elements[i] = { Attributes::semantic, 0, Attributes::format, inputSlot, offsets[i], D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }, ++i), ...);
+			return elements;
+		}
+
+		static void Pack(const Vertex& vertex, uint8_t* destination)
+		{
+			size_t i = 0;
+			(PackAttribute<Attributes>(vertex, destination + offsets[i++]), ...);
+		}
+
+		// destination needs vertices.size() * stride bytes, e.g. a mapped upload buffer
+		static void PackVertices(std::span<const Vertex> vertices, uint8_t* destination)
+		{
+			for (size_t i = 0; i < vertices.size(); ++i)
+				Pack(vertices[i], destination + i * stride);
+		}
+
+	private:
+		template<typename Attribute>
+		static void PackAttribute(const Vertex& vertex, uint8_t* destination)
+		{
+			typename Attribute::Storage storage;
+			Attribute::Pack(vertex, storage);
+			memcpy(destination, &storage, sizeof(storage));
+		}
+	};
+
+	// every stream is bound to the input slot of its index. Positions are a stream of their own so depth and shadow
+	// passes fetch 12 bytes per vertex instead of the whole vertex
+	enum VERTEXSTREAM : uint32_t
+	{
+		STREAM_POSITION = 0,
+		STREAM_ATTRIBUTES = 1,
+		STREAM_COUNT = 2
+	};
+
+	// the vertex shaders decode these layouts (octahedral normal/tangent, bitangent from cross(N, T) * handedness)
+	using PositionStream = Layout<PositionFloat3>;
+	using AttributeStream = Layout<NormalOctahedral, TexCoordHalf2, TangentOctahedral>;
+
+	static_assert(PositionStream::stride == 12 && AttributeStream::stride == 16);
+
+	constexpr uint32_t streamStrides[STREAM_COUNT] = { PositionStream::stride, AttributeStream::stride };
+
+	// HLSL semantics are case insensitive
+	inline bool SemanticEquals(const char* a, const char* b)
+	{
+		for (; *a && *b; ++a, ++b)
+			if (std::toupper(static_cast<unsigned char>(*a)) != std::toupper(static_cast<unsigned char>(*b)))
+				return false;
+		return *a == *b;
+	}
+
+	// input element of the stream that provides semantic/semanticIndex, nullopt if no stream does
+	inline std::optional<D3D12_INPUT_ELEMENT_DESC> FindInputElement(const char* semantic, uint32_t semanticIndex)
+	{
+		for (const D3D12_INPUT_ELEMENT_DESC& element : PositionStream::GetInputElements(STREAM_POSITION))
+			if (element.SemanticIndex == semanticIndex && SemanticEquals(element.SemanticName, semantic))
+				return element;
+
+		for (const D3D12_INPUT_ELEMENT_DESC& element : AttributeStream::GetInputElements(STREAM_ATTRIBUTES))
+			if (element.SemanticIndex == semanticIndex && SemanticEquals(element.SemanticName, semantic))
+				return element;
+
+		return std::nullopt;
+	}
+
+	// packs every stream back to back: positions first, the attributes right after (vertices.size() * 28 bytes in total)
+	inline void PackStreams(std::span<const Vertex> vertices, uint8_t* destination)
+	{
+		PositionStream::PackVertices(vertices, destination);
+		AttributeStream::PackVertices(vertices, destination + vertices.size() * PositionStream::stride);
+	}
+}
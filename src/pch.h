@@ -14,6 +14,7 @@
 #include <sstream>
 #include <numeric>
 #include <filesystem>
+#include <span>
 
 // Windows
 #define WIN32_LEAN_AND_MEAN
@@ -63,15 +64,21 @@ using namespace DirectX;
 #define NUM_MAX_DSV_DESCRIPTORS 1024
 #define NUM_MAX_SAMPLER_DESCRIPTORS 512
 
+// command line tools (artisDX-cook) set it, PRINT then writes to stdout and PRINT_ERROR to stderr as well
+inline bool printToConsole = false;
+
 template<typename... Args>
-inline void PrintHelper(Args&&... args) {
+inline void PrintHelper(std::ostream& console, Args&&... args) {
 	std::ostringstream oss;
 	(oss << ... << args);
 	oss << "\n";
 	OutputDebugStringA(oss.str().c_str());
+	if (printToConsole)
+		console << oss.str() << std::flush;
 }
 
-#define PRINT(...) PrintHelper(__VA_ARGS__)
+#define PRINT(...) PrintHelper(std::cout, __VA_ARGS__)
+#define PRINT_ERROR(...) PrintHelper(std::cerr, __VA_ARGS__)
 
 inline void ThrowIfFailed(HRESULT hr, const std::string& errorMsg = "")
 {
@@ -119,8 +126,7 @@ struct Vertex {
 	XMFLOAT3 position;
 	XMFLOAT3 normal;
 	XMFLOAT2 uv;
-	XMFLOAT4 tangent;
-	XMFLOAT3 bitangent;
+	XMFLOAT4 tangent; // w = handedness, bitangent = cross(normal, tangent.xyz) * w
 };
 
 namespace Utils
@@ -159,6 +165,50 @@ namespace Utils
 		}
 	}
 
+	// case insensitive, ".GLB" is a ".glb" as well
+	inline bool HasExtension(const std::filesystem::path& path, std::string_view extension)
+	{
+		const std::string pathExtension = path.extension().string();
+		return std::equal(pathExtension.begin(), pathExtension.end(), extension.begin(), extension.end(), [](char a, char b)
+			{
+				return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+			});
+	}
+
+	// 64-bit content hash (murmur64a style), used to identify identical source data
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t seed = 0x9E3779B97F4A7C15ull)
+	{
+		constexpr uint64_t m = 0xC6A4A7935BD1E995ull;
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		uint64_t hash = seed ^ (size * m);
+
+		size_t i = 0;
+		for (; i + 8 <= size; i += 8)
+		{
+			uint64_t k;
+			memcpy(&k, bytes + i, 8);
+			k *= m;
+			k ^= k >> 47;
+			k *= m;
+			hash ^= k;
+			hash *= m;
+		}
+
+		if (i < size)
+		{
+			uint64_t tail = 0;
+			memcpy(&tail, bytes + i, size - i);
+			hash ^= tail;
+			hash *= m;
+		}
+
+		hash ^= hash >> 47;
+		hash *= m;
+		hash ^= hash >> 47;
+		return hash;
+	}
+
 	inline XMFLOAT2 ToXMFloat2(const fastgltf::math::nvec2& v)
 	{
 		return XMFLOAT2(v[0], v[1]);